@@ -155,7 +155,7 @@ namespace jsonv
  *  different iterator types in JSON Voorhees. They are aptly-named \c object_iterator and \c array_iterator. The access
  *  methods for these iterators are \c begin_object / \c end_object and \c begin_array / \c end_array, respectively.
  *  The object interface behaves exactly like you would expect a \c std::map<std::string,jsonv::value> to, while the
- *  array interface behaves just like a \c std::deque<jsonv::value> would.
+ *  array interface behaves just like a \c std::vector<jsonv::value> would.
  *  
  *  \code
  *  #include <jsonv/value.hpp>
@@ -730,6 +730,8 @@ namespace jsonv
 #include "encode.hpp"
 #include "forward.hpp"
 #include "functional.hpp"
+#include "lazy_document.hpp"
+#include "memory_resource.hpp"
 #include "parse.hpp"
 #include "path.hpp"
 #include "serialization.hpp"
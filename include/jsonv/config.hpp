@@ -152,6 +152,17 @@
         item(unsigned long long)
 #endif
 
+/** \def JSONV_OBJECT_USE_FLAT_MAP
+ *  \brief Store the members of an object in a sorted \c std::vector instead of a \c std::map.
+ *  This trades iterator and reference stability for fewer allocations and faster lookup and iteration, which is usually
+ *  a good deal for documents made up of many small objects. This changes the type of \c value::object_iterator, so
+ *  the library and everything using it must be compiled with the same setting (the CMake option
+ *  \c USE_FLAT_OBJECT_STORAGE controls it).
+**/
+#ifndef JSONV_OBJECT_USE_FLAT_MAP
+#   define JSONV_OBJECT_USE_FLAT_MAP 0
+#endif
+
 /** \def JSONV_COMPILER_SUPPORTS_TEMPLATE_TEMPLATES
  *  Does the compiler properly support template templates? Most compilers do, MSVC does not.
 **/
@@ -16,12 +16,27 @@
 #include <jsonv/forward.hpp>
 #include <jsonv/string_view.hpp>
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
+#include <string>
+#include <vector>
 
 namespace jsonv
 {
 
-/** An encoder is responsible for writing values to some form of output. **/
+namespace detail
+{
+
+class event_parser;
+class thread_pool;
+
+}
+
+/** An encoder is responsible for writing values to some form of output. Besides encoding a \c value, an encoder can
+ *  receive its calls directly from a parser with \c parse_events, which allows re-encoding JSON input without ever
+ *  building a \c value.
+**/
 class JSONV_PUBLIC encoder
 {
 public:
@@ -31,6 +46,9 @@ public:
     void encode(const jsonv::value& source);
     
 protected:
+    friend class detail::event_parser;
+    friend class event_writer;
+    
     /** Write the null value.
      *  
      *  \code
@@ -136,6 +154,79 @@ protected:
     virtual void write_boolean(bool value) = 0;
 };
 
+/** Writes a JSON value to an \c encoder one piece at a time, without building a \c value for it first. The delimiters
+ *  between the entries of arrays and objects are written as needed, so users only say where things begin and end. This
+ *  is how \c serializer::to_encoder writes C++ values straight to an \c encoder.
+ *  
+ *  \example "event_writer to write an object"
+ *  \code
+ *  jsonv::ostream_encoder encoder(std::cout);
+ *  jsonv::event_writer out(encoder);
+ *  out.object_begin();
+ *  out.key("values");
+ *  out.array_begin();
+ *  for (int x : { 1, 2, 3 })
+ *      out.integer(x);
+ *  out.array_end();
+ *  out.object_end();
+ *  \endcode
+ *  
+ *  All of the functions throw \c std::logic_error if what they write does not belong where it is, such as a key in an
+ *  array or a second value at the top level.
+**/
+class JSONV_PUBLIC event_writer
+{
+public:
+    explicit event_writer(encoder& out);
+    
+    ~event_writer() noexcept;
+    
+    /** Write a complete \a source value. **/
+    void value(const jsonv::value& source);
+    
+    void null();
+    
+    void boolean(bool value);
+    
+    void integer(std::int64_t value);
+    
+    void decimal(double value);
+    
+    void string(string_view value);
+    
+    void array_begin();
+    
+    void array_end();
+    
+    void object_begin();
+    
+    /** Write the \a key for the next entry of the current object, which must be followed by its value. **/
+    void key(string_view key);
+    
+    void object_end();
+    
+private:
+    /** Write the delimiter which comes before a value, if there should be one. **/
+    void before_value();
+    
+    void end(bool object);
+    
+private:
+    enum class state : unsigned char
+    {
+        empty_array,
+        array,
+        empty_object,
+        object,
+    };
+    
+private:
+    encoder&           _out;
+    std::vector<state> _open;
+    bool               _after_key;
+    bool               _done;
+};
+
 /** An encoder that outputs to an \c std::ostream. This implementation is used for \c operator<< on a \c value.
 **/
 class JSONV_PUBLIC ostream_encoder :
@@ -187,28 +278,165 @@ protected:
 protected:
     std::ostream& output();
     
+    /** The current setting of \c ensure_ascii. **/
+    bool ensure_ascii() const;
+    
 private:
     std::ostream& _output;
     bool          _ensure_ascii;
 };
 
-/** Like \c ostream_encoder, but pretty prints output to an \c std::ostream.
+/** An encoder that appends to an \c std::string, either one owned by the caller or an internal buffer which is handed
+ *  to a sink function whenever it fills up. It does its own formatting and escaping instead of going through
+ *  \c std::ostream, so it is much faster than \c ostream_encoder while producing the same output. This is the
+ *  implementation behind \c to_string and \c operator<< on a \c value.
  *  
- *  \example "ostream_pretty_encoder to pretty-print JSON to std::cout"
+ *  \example "buffer_encoder to append to a string"
  *  \code
- *  jsonv::ostream_pretty_encoder encoder(std::cout);
+ *  std::string out = "response=";
+ *  jsonv::buffer_encoder encoder(out);
  *  encoder.encode(some_value);
- *  encoder.encode(another_value);
+ *  \endcode
+ *  
+ *  \example "buffer_encoder to write to a file descriptor"
+ *  \code
+ *  jsonv::buffer_encoder encoder([fd] (jsonv::string_view chunk) { write_all(fd, chunk.data(), chunk.size()); });
+ *  encoder.encode(some_value);
+ *  encoder.flush();
  *  \endcode
 **/
-class JSONV_PUBLIC ostream_pretty_encoder :
-        public ostream_encoder
+class JSONV_PUBLIC buffer_encoder :
+        public encoder
 {
 public:
-    /** Create an instance which places text into \a output. **/
-    explicit ostream_pretty_encoder(std::ostream& output, std::size_t indent_size = 2);
+    /** A function which receives a chunk of encoded output. **/
+    using sink_type = std::function<void (string_view)>;
     
-    virtual ~ostream_pretty_encoder() noexcept;
+public:
+    /** Create an instance which appends text to \a output. **/
+    explicit buffer_encoder(std::string& output);
+    
+    /** Create an instance which gives text to \a sink in chunks of about \a chunk_size bytes. Text is only given to
+     *  the \a sink once a chunk fills up or on \c flush.
+    **/
+    explicit buffer_encoder(sink_type sink, std::size_t chunk_size = 64 * 1024);
+    
+    /** Flushes any remaining text to the sink. Exceptions thrown by the sink are swallowed -- call \c flush first if
+     *  you care about them.
+    **/
+    virtual ~buffer_encoder() noexcept;
+    
+    buffer_encoder(const buffer_encoder&) = delete;
+    buffer_encoder& operator=(const buffer_encoder&) = delete;
+    
+    /** See \c ostream_encoder::ensure_ascii. **/
+    void ensure_ascii(bool value);
+    
+    /** Give all the buffered text to the sink. This does nothing for an instance which appends to a caller's
+     *  \c std::string.
+    **/
+    void flush();
+    
+    /** Encode \a source like \c encode, but split large arrays and objects into runs of entries which are encoded on
+     *  separate threads and then put back together in order. The output is exactly what \c encode would produce.
+     *  
+     *  Arrays and objects with at least \a min_entries entries are split up. Smaller ones are encoded on the calling
+     *  thread, except for any large containers they hold. Subclasses of \c buffer_encoder (like
+     *  \c buffer_pretty_encoder) which change the output are always encoded on the calling thread.
+     *  
+     *  \param thread_count The most threads to use, including the calling thread. The default of 0 means one thread
+     *                      for each hardware thread.
+     *  \param min_entries The fewest entries an array or object needs to be split up.
+    **/
+    void encode_parallel(const value& source, std::size_t thread_count = 0, std::size_t min_entries = 256);
+    
+protected:
+    virtual void write_null() override;
+    
+    virtual void write_object_begin() override;
+    
+    virtual void write_object_end() override;
+    
+    virtual void write_object_key(string_view key) override;
+    
+    virtual void write_object_delimiter() override;
+    
+    virtual void write_array_begin() override;
+    
+    virtual void write_array_end() override;
+    
+    virtual void write_array_delimiter() override;
+    
+    virtual void write_string(string_view value) override;
+    
+    virtual void write_integer(std::int64_t value) override;
+    
+    /** When a special value is given, this will output \c null. **/
+    virtual void write_decimal(double value) override;
+    
+    virtual void write_boolean(bool value) override;
+    
+protected:
+    /** Get the buffer text is currently being appended to. **/
+    std::string& output();
+    
+    /** Flush to the sink if the buffer is full. **/
+    void flush_if_full();
+    
+    /** While \a value is true, \c flush_if_full does nothing. This is for subclasses which might still rewrite the end
+     *  of the buffer.
+    **/
+    void defer_flush(bool value);
+    
+private:
+    friend class ostream_buffered_encoder;
+    
+    void encode_parallel_impl(const value& source, detail::thread_pool& pool, std::size_t min_entries);
+    
+private:
+    std::string  _buffer;
+    std::string& _output;
+    sink_type    _sink;
+    std::size_t  _chunk_size;
+    bool         _ensure_ascii;
+    bool         _defer_flush;
+};
+
+/** Like \c buffer_encoder, but pretty prints output with a newline and indentation for each entry of an array or
+ *  object.
+ *  
+ *  \example "buffer_pretty_encoder to pretty-print JSON into a string"
+ *  \code
+ *  std::string out;
+ *  jsonv::buffer_pretty_encoder encoder(out);
+ *  encoder.compact_width(40);
+ *  encoder.encode(some_value);
+ *  \endcode
+**/
+class JSONV_PUBLIC buffer_pretty_encoder :
+        public buffer_encoder
+{
+public:
+    /** Create an instance which appends text to \a output. **/
+    explicit buffer_pretty_encoder(std::string& output, std::size_t indent_size = 2);
+    
+    /** Create an instance which gives text to \a sink in chunks of about \a chunk_size bytes. **/
+    explicit buffer_pretty_encoder(sink_type sink, std::size_t indent_size = 2, std::size_t chunk_size = 64 * 1024);
+    
+    virtual ~buffer_pretty_encoder() noexcept;
+    
+    /** Keep arrays and objects which do not contain other arrays or objects on a single line, as long as that line is
+     *  no more than \a width characters from the opening bracket to the closing one. Entries of a container kept on one
+     *  line are separated by \c ", " instead of a newline. The default of 0 puts every entry on its own line.
+     *  
+     *  \code
+     *  {
+     *    "position": [1.5, -2, 0],
+     *    "tags": {"a": 1, "b": 2}
+     *  }
+     *  \endcode
+    **/
+    void compact_width(std::size_t width);
     
 protected:
     virtual void write_null() override;
@@ -240,10 +468,137 @@ private:
     
     void write_eol();
     
+    void write_container_begin(char bracket);
+    
+    void write_container_end(char bracket);
+    
+    void write_delimiter(bool newline);
+    
+    void check_compact_width();
+    
+    void expand_compact();
+    
+private:
+    std::size_t              _indent;
+    std::size_t              _indent_size;
+    bool                     _defer_indent;
+    std::string              _indentation;
+    std::size_t              _compact_width;
+    /** Where the container being kept on one line starts in \c output or \c npos if there is not one. **/
+    std::size_t              _compact_start;
+    /** Where each entry of the container being kept on one line starts in \c output. **/
+    std::vector<std::size_t> _compact_entries;
+};
+
+/** An \c ostream_encoder which formats text with a \c buffer_encoder (or a subclass of it) instead of going through the
+ *  stream. The text is written to the stream in large chunks, the last of them when each top-level value is complete.
+ *  The stream itself is never flushed. This is what \c ostream_pretty_encoder and \c json_lines_encoder are built on.
+**/
+class JSONV_PUBLIC ostream_buffered_encoder :
+        public ostream_encoder
+{
+public:
+    virtual ~ostream_buffered_encoder() noexcept;
+    
+protected:
+    /** Create an instance which formats text with \a formatter, which should give its text to \a output (see
+     *  \c stream_sink). The \a formatter is only used once something is encoded, so it can be a member of the subclass.
+     *  
+     *  \param value_suffix Text to put after each top-level value.
+    **/
+    ostream_buffered_encoder(std::ostream& output, buffer_encoder& formatter, std::string value_suffix = std::string());
+    
+    /** Get a \c buffer_encoder::sink_type which writes to \a output. **/
+    static buffer_encoder::sink_type stream_sink(std::ostream& output);
+    
+protected:
+    virtual void write_null() override;
+    
+    virtual void write_object_begin() override;
+    
+    virtual void write_object_end() override;
+    
+    virtual void write_object_key(string_view key) override;
+    
+    virtual void write_object_delimiter() override;
+    
+    virtual void write_array_begin() override;
+    
+    virtual void write_array_end() override;
+    
+    virtual void write_array_delimiter() override;
+    
+    virtual void write_string(string_view value) override;
+    
+    virtual void write_integer(std::int64_t value) override;
+    
+    virtual void write_decimal(double value) override;
+    
+    virtual void write_boolean(bool value) override;
+    
+private:
+    /** Write the formatted text to the stream if a top-level value was just completed. **/
+    void flush_if_complete();
+    
+private:
+    buffer_encoder& _formatter;
+    std::string     _value_suffix;
+    std::size_t     _depth;
+};
+
+/** Like \c ostream_encoder, but pretty prints output to an \c std::ostream. Text is formatted by a
+ *  \c buffer_pretty_encoder and written to the stream in large chunks, the last of them when each value is complete.
+ *  The stream itself is never flushed.
+ *  
+ *  \example "ostream_pretty_encoder to pretty-print JSON to std::cout"
+ *  \code
+ *  jsonv::ostream_pretty_encoder encoder(std::cout);
+ *  encoder.encode(some_value);
+ *  encoder.encode(another_value);
+ *  \endcode
+**/
+class JSONV_PUBLIC ostream_pretty_encoder :
+        public ostream_buffered_encoder
+{
+public:
+    /** Create an instance which places text into \a output. **/
+    explicit ostream_pretty_encoder(std::ostream& output, std::size_t indent_size = 2);
+    
+    virtual ~ostream_pretty_encoder() noexcept;
+    
+    /** See \c buffer_pretty_encoder::compact_width. **/
+    void compact_width(std::size_t width);
+    
+private:
+    buffer_pretty_encoder _pretty;
+};
+
+/** Writes values to an \c std::ostream in the JSON Lines format (also known as NDJSON): every value given to \c encode
+ *  is written compactly on a line of its own, followed by a line feed. Strings never hold a raw line feed in compact
+ *  output, so the result can be read back with \c json_lines_reader.
+ *  
+ *  Like \c ostream_pretty_encoder, the text of each value is built up in a buffer and written to the stream once the
+ *  value is complete.
+ *  
+ *  \example "json_lines_encoder for a log file"
+ *  \code
+ *  std::ofstream file("events.jsonl");
+ *  jsonv::json_lines_encoder encoder(file);
+ *  for (const jsonv::value& event : events)
+ *      encoder.encode(event);
+ *  \endcode
+**/
+class JSONV_PUBLIC json_lines_encoder :
+        public ostream_buffered_encoder
+{
+public:
+    /** Create an instance which places text into \a output. **/
+    explicit json_lines_encoder(std::ostream& output);
+    
+    virtual ~json_lines_encoder() noexcept;
+    
 private:
-    std::size_t   _indent;
-    std::size_t   _indent_size;
-    bool          _defer_indent;
+    buffer_encoder _line;
 };
 
 }
@@ -0,0 +1,182 @@
+/** \file jsonv/lazy_document.hpp
+ *  A document which is only parsed as far as it is looked at.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_LAZY_DOCUMENT_HPP_INCLUDED__
+#define __JSONV_LAZY_DOCUMENT_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/optional.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/path.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jsonv
+{
+
+class lazy_document;
+
+/** A value somewhere in a \c lazy_document. This is only a reference to a position in the document, so it is cheap to
+ *  copy, but it is only valid for as long as the \c lazy_document it came from.
+**/
+class JSONV_PUBLIC lazy_value
+{
+public:
+    using size_type = value::size_type;
+
+public:
+    /** Get the kind of this value. This is known without decoding anything, except for numbers, which are decoded to
+     *  tell \c kind::integer from \c kind::decimal.
+    **/
+    jsonv::kind kind() const;
+
+    /** Get the JSON text of this value in the input, which covers everything between the brackets for an array or
+     *  object (including the brackets).
+    **/
+    string_view text() const;
+
+    /** Get the number of entries in this array or object.
+     *
+     *  \throws kind_error if this is not an array or object.
+    **/
+    size_type size() const;
+
+    /** Get the entry at \a idx of this array. Entries before it are skipped over without looking inside them.
+     *
+     *  \throws kind_error if this is not an array.
+     *  \throws std::out_of_range if \a idx is not less than \c size.
+    **/
+    lazy_value at(size_type idx) const;
+    
+    /** Get every entry of this array, in order. This walks the array once, where calling \c at for each index walks it
+     *  from the start each time.
+     *
+     *  \throws kind_error if this is not an array.
+    **/
+    std::vector<lazy_value> elements() const;
+
+    /** Get the value for \a key in this object.
+     *
+     *  \throws kind_error if this is not an object.
+     *  \throws std::out_of_range if there is no such key.
+    **/
+    lazy_value at(string_view key) const;
+
+    /** Look for the value for \a key in this object. Values of the keys before it are skipped over without looking
+     *  inside them. Duplicate keys are not detected, so if \a key appears more than once, this finds the first one.
+     *
+     *  \throws kind_error if this is not an object.
+    **/
+    optional<lazy_value> find(string_view key) const;
+    
+    /** Get every key and value of this object, in order, with the keys decoded. This walks the object once, where
+     *  calling \c find for each key walks it from the start each time. Duplicate keys are all included.
+     *
+     *  \throws kind_error if this is not an object.
+    **/
+    std::vector<std::pair<std::string, lazy_value>> entries() const;
+
+    /** Get the value at the path \a p from this one. This is like \c value::at_path.
+     *
+     *  \throws std::out_of_range if any path along the chain did not exist.
+     *  \throws kind_error if the path traversal is not valid for the value (for example: if the path specifies an array
+     *   index when the value is an object).
+    **/
+    lazy_value at_path(const path& p) const;
+    lazy_value at_path(string_view p) const;
+
+    /** Parse the text of this value (and everything in it) into a \c value, with the \c parse_options the document was
+     *  created with.
+     *
+     *  \throws parse_error if the text has a problem which was not found when the document was created, such as a badly
+     *   encoded string. The locations of the problems are in the whole input.
+    **/
+    value to_value() const;
+
+private:
+    friend class lazy_document;
+
+    lazy_value(const lazy_document* document, std::size_t index);
+
+private:
+    const lazy_document* _document;
+    std::size_t          _index;
+};
+
+/** A JSON document which is only parsed as far as it is looked at. Creating one makes a single pass over the input to
+ *  check its structure and record a "tape" with an entry for each value in the input. The entry for an array or object
+ *  knows how many entries of the tape its contents take, so walking to a particular key or index jumps over everything
+ *  else in a single step each. Strings, numbers and the like are only decoded by \c lazy_value::to_value, so reading
+ *  a few values out of a large document is much faster than \c parse, which builds a \c value for everything.
+ *
+ *  \example "lazy_document to pick a few fields out of a large document"
+ *  \code
+ *  jsonv::lazy_document doc(request_body);
+ *  std::string   user  = doc.root().at("user").at("name").to_value().as_string();
+ *  std::int64_t  count = doc.root().at_path(".items[3].count").to_value().as_integer();
+ *  \endcode
+ *
+ *  The structure of the input is fully checked up front: brackets must match, keys and values must be in the right
+ *  places and every token must be valid. The \c parse_options for comments, trailing commas, structure depth, whether
+ *  the root must be an array or object and whether there can be trailing data are all applied then. Problems with
+ *  the contents of strings and numbers are only found when they are decoded. Unlike \c parse, the first problem is
+ *  always thrown immediately, since there is no partial result to build.
+ *
+ *  The input must outlive this instance and every \c value made by \c lazy_value::to_value with
+ *  \c parse_options::borrow_input.
+**/
+class JSONV_PUBLIC lazy_document
+{
+public:
+    /** Check the structure of \a input and build the tape for it.
+     *
+     *  \throws parse_error if the structure of \a input is not valid.
+    **/
+    explicit lazy_document(string_view input, const parse_options& options = parse_options());
+
+    ~lazy_document() noexcept;
+
+    // every lazy_value refers to the instance it came from, so it can not move
+    lazy_document(const lazy_document&) = delete;
+    lazy_document& operator=(const lazy_document&) = delete;
+
+    /** Get the root value of the document. **/
+    lazy_value root() const;
+
+private:
+    friend class lazy_value;
+
+    /** An entry on the tape for a single value or object key. **/
+    struct tape_entry
+    {
+        std::size_t offset;  //!< Where the text of the value starts in the input.
+        std::size_t length;  //!< The length of the text, which covers the brackets of arrays and objects.
+        std::size_t skip;    //!< How many tape entries this value takes (including itself and object keys).
+        std::size_t size;    //!< The number of entries in an array or object.
+        jsonv::kind kind;    //!< Numbers are all \c kind::integer until they are decoded.
+    };
+
+    class builder;
+
+private:
+    string_view             _input;
+    parse_options           _options;
+    std::vector<tape_entry> _tape;
+};
+
+}
+
+#endif/*__JSONV_LAZY_DOCUMENT_HPP_INCLUDED__*/
@@ -0,0 +1,202 @@
+/** \file jsonv/memory_resource.hpp
+ *  Control over where the memory for \c value trees comes from.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_MEMORY_RESOURCE_HPP_INCLUDED__
+#define __JSONV_MEMORY_RESOURCE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <cstddef>
+
+namespace jsonv
+{
+
+/** \addtogroup Value
+ *  \{
+**/
+
+/** A source of memory for the internal storage of \c value instances. This is modeled after
+ *  \c std::pmr::memory_resource, which is not available in C++14.
+ *
+ *  \see parse_options::resource
+**/
+class JSONV_PUBLIC memory_resource
+{
+public:
+    virtual ~memory_resource() noexcept;
+
+    /** Get at least \a bytes of memory aligned to \a alignment.
+     *
+     *  \throws std::bad_alloc if the memory could not be allocated.
+    **/
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        return do_allocate(bytes, alignment);
+    }
+
+    /** Give back memory \a p which was obtained by a call to \c allocate with the same \a bytes and \a alignment. **/
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    /** Can memory allocated from this resource be deallocated from \a other and vice versa? **/
+    bool is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other || do_is_equal(other);
+    }
+
+protected:
+    virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+
+    virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+};
+
+/** Get the \c memory_resource which uses the global \c operator \c new and \c operator \c delete. This is what every
+ *  \c value uses unless told otherwise.
+**/
+JSONV_PUBLIC memory_resource* new_delete_resource() noexcept;
+
+/** A \c memory_resource which hands out memory from large blocks and only gives it back when the resource is released
+ *  or destroyed. Allocation is a pointer bump and deallocation does nothing, which makes it ideal for parsing a
+ *  document, using it and dropping the whole thing.
+ *
+ *  \example "monotonic_buffer_resource for a request"
+ *  \code
+ *  jsonv::monotonic_buffer_resource arena;
+ *  jsonv::value request = jsonv::parse(text, jsonv::parse_options().resource(&arena));
+ *  handle(request);
+ *  // request must be destroyed (or moved from) before arena is
+ *  \endcode
+ *
+ *  This is not thread-safe -- only use a single instance from one thread at a time.
+**/
+class JSONV_PUBLIC monotonic_buffer_resource :
+        public memory_resource
+{
+public:
+    /** Create an instance.
+     *
+     *  \param initial_size The size of the first block to get from \a upstream. Each block after it is twice the size
+     *                      of the last.
+     *  \param upstream Where to get blocks from. This must outlive this instance.
+    **/
+    explicit monotonic_buffer_resource(std::size_t      initial_size = 4096,
+                                       memory_resource* upstream     = new_delete_resource()
+                                      );
+
+    virtual ~monotonic_buffer_resource() noexcept;
+
+    monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+    monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+    /** Give every block back to the upstream resource. Everything allocated from this instance is invalidated. **/
+    void release() noexcept;
+
+    /** The number of bytes obtained from the upstream resource. **/
+    std::size_t upstream_bytes() const noexcept;
+
+protected:
+    virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+    virtual bool do_is_equal(const memory_resource& other) const noexcept override;
+
+private:
+    struct block;
+
+private:
+    memory_resource* _upstream;
+    std::size_t      _next_size;
+    block*           _blocks;
+    char*            _current;
+    char*            _end;
+};
+
+/** \} **/
+
+namespace detail
+{
+
+/** An allocator which gets its memory from a \c memory_resource, like \c std::pmr::polymorphic_allocator. Copying a
+ *  container which uses it creates a copy using \c new_delete_resource, so a copy never refers to the memory of the
+ *  original.
+**/
+template <typename T>
+class resource_allocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = resource_allocator<U>;
+    };
+
+public:
+    resource_allocator() noexcept :
+            _resource(new_delete_resource())
+    { }
+
+    resource_allocator(memory_resource* resource) noexcept :
+            _resource(resource)
+    { }
+
+    template <typename U>
+    resource_allocator(const resource_allocator<U>& source) noexcept :
+            _resource(source.resource())
+    { }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(_resource->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t count) noexcept
+    {
+        _resource->deallocate(p, count * sizeof(T), alignof(T));
+    }
+
+    resource_allocator select_on_container_copy_construction() const
+    {
+        return resource_allocator();
+    }
+
+    memory_resource* resource() const noexcept
+    {
+        return _resource;
+    }
+
+    template <typename U>
+    bool operator==(const resource_allocator<U>& other) const noexcept
+    {
+        return _resource->is_equal(*other.resource());
+    }
+
+    template <typename U>
+    bool operator!=(const resource_allocator<U>& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    memory_resource* _resource;
+};
+
+}
+
+}
+
+#endif/*__JSONV_MEMORY_RESOURCE_HPP_INCLUDED__*/
@@ -17,11 +17,14 @@
 
 #include <cstddef>
 #include <deque>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace jsonv
 {
 
+class encoder;
 class tokenizer;
 
 /** An error encountered when parsing.
@@ -261,18 +264,59 @@ public:
     bool comments() const;
     parse_options& comments(bool);
     
+    /** If set to true, short strings which appear many times in the input (such as the values of an enumeration-like
+     *  field or the keys of objects in an array) are only decoded once. Every \c value created from the same string
+     *  shares a single copy of its contents. This is off by default, since it adds a hash table lookup for each string
+     *  in the input, which only pays off when there is repetition.
+     *  
+     *  Object keys are stored in their own \c std::string, so they skip the decoding but not the copy.
+    **/
+    bool intern_strings() const;
+    parse_options& intern_strings(bool);
+    
+    /** Where the storage for the strings, arrays and objects of the parsed document comes from. By default, this is
+     *  \c new_delete_resource. Using a \c monotonic_buffer_resource turns the thousands of small allocations made when
+     *  parsing a large document into a few large ones and makes destroying the result nearly free.
+     *  
+     *  The resulting \c value and everything moved out of it must be destroyed before the \a resource is. Copying any
+     *  part of it makes a heap-backed copy which has no such restriction. Values from anywhere can be freely mixed
+     *  together -- each one remembers where its storage came from.
+     *  
+     *  Only the nodes of the tree come from \a resource. Characters of strings too long for the small-string buffer of
+     *  \c std::string, object keys and strings shared through \c intern_strings are still heap-allocated, since they
+     *  are exposed as plain \c std::string instances.
+    **/
+    memory_resource* resource() const;
+    parse_options& resource(memory_resource*);
+    
+    /** If set to true, strings which need no decoding (printable ASCII without escape sequences, which is most of them)
+     *  refer directly to the characters of the input instead of copying them. \c value::as_string_view returns a view
+     *  of the input, while \c value::as_string makes an \c std::string copy the first time it is called. Strings which
+     *  do need decoding are decoded during the parse as usual, so decoding errors are still reported by \c parse.
+     *  
+     *  This is off by default, because the input must outlive the result and everything moved out of it. Copying a
+     *  \c value makes a copy of the characters, so a copy has no such restriction. This only applies when parsing a
+     *  \c string_view or a range of characters -- input from an \c std::istream is buffered internally and the buffer
+     *  is reused as parsing continues, so it is always copied.
+    **/
+    bool borrow_input() const;
+    parse_options& borrow_input(bool);
+    
 private:
     // For the purposes of ABI compliance, most modifications to the variables in this class should bump the minor
     // version number.
-    on_error    _failure_mode     = on_error::fail_immediately;
-    std::size_t _max_failures     = 10;
-    encoding    _string_encoding  = encoding::utf8;
-    numbers     _number_encoding  = numbers::decimal;
-    commas      _comma_policy     = commas::allow_trailing;
-    size_type   _max_struct_depth = 0;
-    bool        _require_document = false;
-    bool        _complete_parse   = true;
-    bool        _comments         = true;
+    on_error         _failure_mode     = on_error::fail_immediately;
+    std::size_t      _max_failures     = 10;
+    encoding         _string_encoding  = encoding::utf8;
+    numbers          _number_encoding  = numbers::decimal;
+    commas           _comma_policy     = commas::allow_trailing;
+    size_type        _max_struct_depth = 0;
+    bool             _require_document = false;
+    bool             _complete_parse   = true;
+    bool             _comments         = true;
+    bool             _intern_strings   = false;
+    memory_resource* _resource         = new_delete_resource();
+    bool             _borrow_input     = false;
 };
 
 /** Reads a JSON value from the input stream.
@@ -307,6 +351,42 @@ value JSONV_PUBLIC parse(const string_view& input, const parse_options& = parse_
 **/
 value JSONV_PUBLIC parse(const char* begin, const char* end, const parse_options& = parse_options());
 
+/** Construct a JSON value from the contents of the file at \a path. The file is memory-mapped and tokenized in place,
+ *  so it is never copied through an \c std::istream or into an \c std::string.
+ *  
+ *  The mapping is closed when this returns, so strings are always copied out of it, even with
+ *  \c parse_options::borrow_input.
+ *  
+ *  \throws std::system_error if the file can not be opened or mapped.
+ *  \throws parse_error if an error is found in the JSON.
+**/
+value JSONV_PUBLIC parse_file(const std::string& path, const parse_options& = parse_options());
+
+/** Construct a JSON value from the given input like \c parse, but when the input is a large array, split its entries
+ *  into runs which are parsed on separate threads and then put back together in order. The result is exactly what
+ *  \c parse would produce.
+ *
+ *  A quick pass over the input finds the commas between the top-level entries, skipping over strings and nested
+ *  structures. Input which is not an array with at least \a min_entries entries is parsed on the calling thread, as is
+ *  input with comments or which is too deeply nested for \c parse_options::max_structure_depth. A \c memory_resource
+ *  other than \c new_delete_resource is not safe to use from multiple threads, so setting
+ *  \c parse_options::resource also means parsing on the calling thread.
+ *
+ *  If any run has a problem, the whole input is parsed again on the calling thread, so the \c parse_error::problem
+ *  list (with the line and column of each problem) and the partial result are the same as from \c parse.
+ *
+ *  \param thread_count The most threads to use, including the calling thread. The default of 0 means one thread for
+ *                      each hardware thread.
+ *  \param min_entries The fewest entries the top-level array needs to be split up.
+ *
+ *  \throws parse_error if an error is found in the JSON.
+**/
+value JSONV_PUBLIC parse_parallel(const string_view&    input,
+                                  const parse_options&  options      = parse_options(),
+                                  std::size_t           thread_count = 0,
+                                  std::size_t           min_entries  = 256
+                                 );
+
 /** Reads a JSON value from a buffered \c tokenizer. This less convenient function is useful when setting
  *  \c parse_options::complete_parse to \c false.
  *  
@@ -323,6 +403,190 @@ value JSONV_PUBLIC parse(const char* begin, const char* end, const parse_options
 **/
 value JSONV_PUBLIC parse(tokenizer& input, const parse_options& = parse_options());
 
+/** Parse JSON from a \c tokenizer, calling the \c encoder functions of \a handler as the JSON is encountered instead of
+ *  constructing a \c value. The \a handler receives calls in the same order as if the parsed \c value was passed to
+ *  \c encoder::encode, which makes it possible to filter, count or re-encode a document without ever allocating the
+ *  entire tree.
+ *  
+ *  \example "parse_events(std::istream&, encoder&, const parse_options&)"
+ *  Minify a JSON file without building a \c value.
+ *  \code
+ *  std::ifstream file("file.json");
+ *  jsonv::ostream_encoder minifier(std::cout);
+ *  jsonv::parse_events(file, minifier);
+ *  \endcode
+ *  
+ *  The \c parse_options are respected with a few differences from \c parse:
+ *  
+ *   - Object keys are passed to \a handler as they appear, so duplicate keys are not detected.
+ *   - When \c parse_options::failure_mode is not \c on_error::fail_immediately, tokens which do not fit are skipped
+ *     and unterminated structures are closed at the end of input, so \a handler still sees a well-formed sequence of
+ *     calls. When collecting errors, the thrown \c parse_error has a \c null partial result.
+ *  
+ *  \throws parse_error if an error is found in the JSON. Anything thrown by \a handler is propagated.
+**/
+void JSONV_PUBLIC parse_events(tokenizer& input, encoder& handler, const parse_options& = parse_options());
+
+/** Parse JSON from the input stream, calling the functions of \a handler as the JSON is encountered.
+ *  
+ *  \see parse_events(tokenizer&, encoder&, const parse_options&)
+**/
+void JSONV_PUBLIC parse_events(std::istream& input, encoder& handler, const parse_options& = parse_options());
+
+/** Parse JSON from the given \a input, calling the functions of \a handler as the JSON is encountered.
+ *  
+ *  \see parse_events(tokenizer&, encoder&, const parse_options&)
+**/
+void JSONV_PUBLIC parse_events(const string_view& input, encoder& handler, const parse_options& = parse_options());
+
+/** Parses JSON which arrives in pieces, such as from a network socket. Instead of buffering an entire message before
+ *  calling \c parse, give each chunk to \c feed as it is received. The parser keeps its state (the stack of open
+ *  structures, the partially-built value and the line and column for error messages) between calls and only holds on
+ *  to the bytes of a token which is split across chunks.
+ *  
+ *  \example "incremental_parser for chunked input"
+ *  \code
+ *  jsonv::incremental_parser parser;
+ *  while (parser.feed(socket.receive()) == jsonv::incremental_parser::status::need_more)
+ *  { }
+ *  handle_message(std::move(parser.result()));
+ *  \endcode
+ *  
+ *  A root value is \c status::complete as soon as its final token is seen. Since a number or literal at the root might
+ *  continue in the next chunk, these are only known to be complete after \c finish is called. If
+ *  \c parse_options::complete_parse is \c false, input after a complete value is left unparsed; calling \c reset and
+ *  then \c feed (an empty chunk is fine) parses the next value from it. Otherwise, input after the complete value is
+ *  checked to make sure it is only whitespace.
+ *  
+ *  Errors are reported the same way \c parse reports them: by throwing a \c parse_error. When collecting errors, the
+ *  \c parse_error is thrown once the value is complete or \c finish is called. After an error, the parser must be
+ *  \c reset before it is used again.
+**/
+class JSONV_PUBLIC incremental_parser
+{
+public:
+    /** The state of parsing after receiving input. **/
+    enum class status : unsigned char
+    {
+        /** The input so far is the beginning of a value -- more input is needed. **/
+        need_more,
+        /** A complete value has been parsed and is available from \c result. **/
+        complete,
+    };
+    
+public:
+    explicit incremental_parser(const parse_options& options = parse_options());
+    
+    ~incremental_parser() noexcept;
+    
+    incremental_parser(const incremental_parser&) = delete;
+    incremental_parser& operator=(const incremental_parser&) = delete;
+    
+    /** Give the next \a chunk of input to the parser. The contents of \a chunk are copied if needed, so it does not
+     *  need to outlive this call.
+     *  
+     *  \throws parse_error if the input is not valid JSON.
+    **/
+    status feed(string_view chunk);
+    
+    /** Signal that there is no more input.
+     *  
+     *  \returns \c status::complete if a value was parsed. If the input ended in the middle of a value, a
+     *   \c parse_error is thrown (unless \c parse_options::failure_mode is \c on_error::ignore, in which case the value
+     *   is closed as best as possible).
+     *  \throws parse_error if the input is not valid JSON.
+    **/
+    status finish();
+    
+    /** Get the parsed value.
+     *  
+     *  \throws std::logic_error if the last call to \c feed or \c finish did not return \c status::complete.
+    **/
+    value& result();
+    
+    /** Prepare to parse another value. Any input after the previous value which was not parsed is kept. **/
+    void reset();
+    
+private:
+    class impl;
+    
+    std::unique_ptr<impl> _impl;
+};
+
+/** Reads a sequence of values in the JSON Lines format (also known as NDJSON), where each line of the input is a
+ *  complete JSON document. Lines which are empty or only whitespace are skipped. A line may end with \c "\r\n".
+ *  
+ *  Every line is parsed with the same \c parse_options, reusing the same internal buffers and parser state, so this is
+ *  much cheaper than splitting lines and calling \c parse on each one. Problems are reported with the line number and
+ *  character offset in the whole input, not just within the line.
+ *  
+ *  \example "json_lines_reader for a log file"
+ *  \code
+ *  std::ifstream file("events.jsonl");
+ *  jsonv::json_lines_reader reader(file);
+ *  jsonv::value event;
+ *  while (reader.next(event))
+ *      handle_event(event);
+ *  \endcode
+ *  
+ *  \example "json_lines_reader in parallel batches"
+ *  \code
+ *  jsonv::json_lines_reader reader(mapped_file_contents);
+ *  std::vector<jsonv::value> events;
+ *  while (reader.next_batch(events, 10000) > 0)
+ *  {
+ *      handle_events(events);
+ *      events.clear();
+ *  }
+ *  \endcode
+**/
+class JSONV_PUBLIC json_lines_reader
+{
+public:
+    /** Read lines from \a input, which must outlive this instance. **/
+    explicit json_lines_reader(std::istream& input, const parse_options& options = parse_options());
+    
+    /** Read lines from \a input (such as the contents of a memory-mapped file), which must outlive this instance. With
+     *  \c parse_options::borrow_input, strings in the values can refer to the text of \a input.
+    **/
+    explicit json_lines_reader(string_view input, const parse_options& options = parse_options());
+    
+    ~json_lines_reader() noexcept;
+    
+    json_lines_reader(const json_lines_reader&) = delete;
+    json_lines_reader& operator=(const json_lines_reader&) = delete;
+    
+    /** Parse the next line which is not blank into \a out.
+     *  
+     *  \returns \c true if a value was parsed or \c false if there are no more lines.
+     *  \throws parse_error if the line is not valid JSON. The line is skipped, so reading can continue with the next
+     *   one.
+    **/
+    bool next(value& out);
+    
+    /** Parse up to \a max_count of the next lines which are not blank, appending a value for each to \a out in order.
+     *  The lines are split into runs which are parsed on separate threads. A \c memory_resource other than
+     *  \c new_delete_resource is not safe to use from multiple threads, so setting \c parse_options::resource means
+     *  parsing on the calling thread.
+     *  
+     *  \param thread_count The most threads to use, including the calling thread. The default of 0 means one thread
+     *                      for each hardware thread.
+     *  \returns The number of values appended to \a out, which is 0 once there are no more lines.
+     *  \throws parse_error if any line is not valid JSON, after every line has been parsed. The error holds the
+     *   problems from every line which had them (up to \c parse_options::max_failures). A value is still appended to
+     *   \a out for each line with problems -- this is the partial result of that line.
+    **/
+    std::size_t next_batch(std::vector<value>& out, std::size_t max_count, std::size_t thread_count = 0);
+    
+    /** Get the line number (starting at 1) of the last line read, or 0 if nothing has been read. **/
+    std::size_t line() const;
+    
+private:
+    class impl;
+    
+    std::unique_ptr<impl> _impl;
+};
+
 }
 
 #endif/*__JSONV_PARSE_HPP_INCLUDED__*/
@@ -15,6 +15,8 @@
 #include <jsonv/config.hpp>
 #include <jsonv/detail/nested_exception.hpp>
 #include <jsonv/detail/scope_exit.hpp>
+#include <jsonv/encode.hpp>
+#include <jsonv/lazy_document.hpp>
 #include <jsonv/path.hpp>
 #include <jsonv/value.hpp>
 
@@ -229,6 +231,16 @@ public:
                          const value&              from,
                          void*                     into
                         ) const = 0;
+    
+    /** Extract the type from a \c lazy_value \a from into a region of memory. This is what \c extract_json uses, so
+     *  an \c extractor which only needs to look at part of its input can skip the rest without decoding it. By
+     *  default, this decodes all of \a from with \c lazy_value::to_value and calls \c extract, which is the right thing
+     *  to do for an \c extractor which needs the whole \c value anyway.
+    **/
+    virtual void extract_lazy(const extraction_context& context,
+                              const lazy_value&         from,
+                              void*                     into
+                             ) const;
 };
 
 /** A \c serializer holds the method for converting an arbitrary C++ type into a \c value. **/
@@ -254,6 +266,18 @@ public:
     virtual value to_json(const serialization_context& context,
                           const void*                  from
                          ) const = 0;
+    
+    /** Write the value in the given region of memory straight to \a out, without building a \c value for it. By
+     *  default, this writes the result of \c to_json, so only a \c serializer which can do better needs to override it.
+     *  
+     *  \param context Same as for \c to_json. Use \c serialization_context::to_encoder to write sub-objects.
+     *  \param from Same as for \c to_json.
+     *  \param out Where to write exactly one JSON value.
+    **/
+    virtual void to_encoder(const serialization_context& context,
+                            const void*                  from,
+                            event_writer&                out
+                           ) const;
 };
 
 /** An \c adapter is both an \c extractor and a \c serializer. It is made with the idea that for \e most types, you want
@@ -387,6 +411,16 @@ public:
     **/
     static formats compose(const list& bases);
     
+    /** Create a new \c formats with the same \c extractor and \c serializer for every type as this one, but kept in a
+     *  single table instead of a graph of bases. Looking something up in a \c formats composed several levels deep
+     *  searches each level in turn, which adds up when it happens for every value extracted or encoded. The flattened
+     *  instance finds anything with a single lookup.
+     *  
+     *  The result is a snapshot: anything registered with this instance or any of its bases afterwards is not seen by
+     *  it. Things can still be registered with the result, like any other \c formats.
+    **/
+    formats flatten() const;
+    
     /** Extract the provided \a type \a from a \c value \a into an area of memory. The \a context is passed to the
      *  \c extractor which performs the conversion. In general, this should not be used directly as it is quite painful
      *  to do so -- prefer \c extraction_context::extract or the free function \c jsonv::extract.
@@ -583,6 +617,34 @@ public:
                  void*                     into
                 ) const;
     
+    /** Attempt to extract a \c T from the \c lazy_value \a from using the \c formats associated with this context.
+     *  
+     *  \tparam T is the type to extract from \a from. It must be movable.
+     *  
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    template <typename T>
+    T extract(const lazy_value& from) const
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type place[1];
+        T* ptr = reinterpret_cast<T*>(place);
+        extract(typeid(T), from, static_cast<void*>(ptr));
+        auto destroy = detail::on_scope_exit([ptr] { ptr->~T(); });
+        return std::move(*ptr);
+    }
+    
+    void extract(const std::type_info&     type,
+                 const lazy_value&         from,
+                 void*                     into
+                ) const;
+    
+    /** Extract with \a ex instead of looking up an \c extractor in \c formats. Errors are handled the same way as the
+     *  other \c extract functions. This is what \c extractor_handle uses.
+    **/
+    void extract(const extractor& ex, const value& from, void* into) const;
+    
+    void extract(const extractor& ex, const lazy_value& from, void* into) const;
+    
     /** Attempt to extract a \c T from <tt>from.at_path(subpath)</tt> using the \c formats associated with this context.
      *  
      *  \tparam T is the type to extract from \a from. It must be movable.
@@ -613,10 +675,134 @@ public:
         return extract_sub<T>(from, jsonv::path({ elem }));
     }
     
+    /** Attempt to extract a \c T from <tt>from.at_path(subpath)</tt> of the \c lazy_value \a from using the \c formats
+     *  associated with this context.
+     *  
+     *  \tparam T is the type to extract from \a from. It must be movable.
+     *  
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    template <typename T>
+    T extract_sub(const lazy_value& from, jsonv::path subpath) const
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type place[1];
+        T* ptr = reinterpret_cast<T*>(place);
+        extract_sub(typeid(T), from, std::move(subpath), static_cast<void*>(ptr));
+        auto destroy = detail::on_scope_exit([ptr] { ptr->~T(); });
+        return std::move(*ptr);
+    }
+    
+    void extract_sub(const std::type_info& type, const lazy_value& from, jsonv::path subpath, void* into) const;
+    
+    /** Attempt to extract a \c T from <tt>from.at_path({elem})</tt> of the \c lazy_value \a from using the \c formats
+     *  associated with this context.
+     *  
+     *  \tparam T is the type to extract from \a from. It must be movable.
+     *  
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    template <typename T>
+    T extract_sub(const lazy_value& from, path_element elem) const
+    {
+        return extract_sub<T>(from, jsonv::path({ elem }));
+    }
+    
+    /** Attempt to extract a \c T from \a child, which is the entry at \a elem of the value being extracted. This is
+     *  the same as \c extract_sub, but for when the entry has already been found.
+     *  
+     *  \tparam T is the type to extract from \a child. It must be movable.
+     *  \tparam TFrom is \c value or \c lazy_value.
+     *  
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    template <typename T, typename TFrom>
+    T extract_child(const TFrom& child, path_element elem) const
+    {
+        extraction_context sub(*this);
+        sub._path += std::move(elem);
+        return sub.extract<T>(child);
+    }
+    
+    /** Attempt to extract a \c T from each entry of the array \a from, calling \a out with each one in order. This
+     *  walks the array once, where calling \c extract_sub for each index would walk it from the start each time.
+     *  
+     *  \tparam T is the type to extract from each entry of \a from. It must be movable.
+     *  
+     *  \throws kind_error if \a from is not an array.
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    template <typename T, typename FOut>
+    void extract_elements(const lazy_value& from, FOut&& out) const
+    {
+        value::size_type idx = 0;
+        for (const lazy_value& element : from.elements())
+        {
+            extraction_context sub(*this);
+            sub._path += path_element(idx++);
+            out(sub.extract<T>(element));
+        }
+    }
+    
 private:
     jsonv::path _path;
 };
 
+/** An \c extractor for \c T which is looked up once, for extracting lots of values without looking it up for each one.
+ *  This is only valid for as long as the \c extractor is, which is at least as long as the \c formats it came from.
+ *  
+ *  \example "extractor_handle to extract in a loop"
+ *  \code
+ *  jsonv::extraction_context         context(fmts);
+ *  jsonv::extractor_handle<my_type> handle(fmts);
+ *  for (const jsonv::value& x : input.as_array())
+ *      out.push_back(handle.extract(context, x));
+ *  \endcode
+**/
+template <typename T>
+class extractor_handle
+{
+public:
+    /** Look up the \c extractor for \c T in \a fmts.
+     *  
+     *  \throws no_extractor if \a fmts does not have an \c extractor for \c T.
+    **/
+    explicit extractor_handle(const formats& fmts) :
+            _extractor(&fmts.get_extractor(typeid(T)))
+    { }
+    
+    /** Extract a \c T from \a from. This is like \c extraction_context::extract, except the \c formats of the
+     *  \a context are not used to find the \c extractor for \c T (but they are for anything inside of it).
+     *  
+     *  \throws extraction_error if anything goes wrong when attempting to extract a value.
+    **/
+    T extract(const extraction_context& context, const value& from) const
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type place[1];
+        T* ptr = reinterpret_cast<T*>(place);
+        context.extract(*_extractor, from, static_cast<void*>(ptr));
+        auto destroy = detail::on_scope_exit([ptr] { ptr->~T(); });
+        return std::move(*ptr);
+    }
+    
+    T extract(const extraction_context& context, const lazy_value& from) const
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type place[1];
+        T* ptr = reinterpret_cast<T*>(place);
+        context.extract(*_extractor, from, static_cast<void*>(ptr));
+        auto destroy = detail::on_scope_exit([ptr] { ptr->~T(); });
+        return std::move(*ptr);
+    }
+    
+    /** Get the \c extractor this handle uses. **/
+    const extractor& get() const
+    {
+        return *_extractor;
+    }
+    
+private:
+    const extractor* _extractor;
+};
+
 /** Extract a C++ value from \a from using the provided \a fmts. **/
 template <typename T>
 T extract(const value& from, const formats& fmts)
@@ -633,6 +819,33 @@ T extract(const value& from)
     return context.extract<T>(from);
 }
 
+/** Extract a C++ value straight from the JSON text \a json using the provided \a fmts. This is like calling \c extract
+ *  on the result of \c parse, but the input is only checked and indexed with a \c lazy_document instead of being built
+ *  into a \c value, so members which no \c extractor asks for are skipped without being decoded.
+ *  
+ *  \throws parse_error if the structure of \a json is not valid. Duplicate keys are not reported.
+ *  \throws extraction_error if anything goes wrong when attempting to extract a value. This includes problems with the
+ *   contents of strings and numbers, which are only found when something is extracted from them (the \c parse_error
+ *   is nested).
+**/
+template <typename T>
+T extract_json(string_view json, const formats& fmts, const parse_options& options = parse_options())
+{
+    lazy_document document(json, options);
+    extraction_context context(fmts);
+    return context.extract<T>(document.root());
+}
+
+/** Extract a C++ value straight from the JSON text \a json using \c jsonv::formats::global().
+ *  
+ *  \see extract_json
+**/
+template <typename T>
+T extract_json(string_view json)
+{
+    return extract_json<T>(json, formats::global());
+}
+
 class JSONV_PUBLIC serialization_context :
         public context_base
 {
@@ -663,6 +876,22 @@ public:
      *  \see formats::to_json
     **/
     value to_json(const std::type_info& type, const void* from) const;
+    
+    /** Convenience function for writing a C++ object straight to \a out.
+     *  
+     *  \see serializer::to_encoder
+    **/
+    template <typename T>
+    void to_encoder(const T& from, event_writer& out) const
+    {
+        to_encoder(typeid(T), static_cast<const void*>(&from), out);
+    }
+    
+    /** Dynamically write a type straight to \a out.
+     *  
+     *  \throws no_serializer if a \c serializer for \a type could not be found.
+    **/
+    void to_encoder(const std::type_info& type, const void* from, event_writer& out) const;
 };
 
 /** Encode a JSON \c value from \a from using the provided \a fmts. **/
@@ -681,6 +910,27 @@ value to_json(const T& from)
     return context.to_json(from);
 }
 
+/** Encode \a from straight to \a out using the provided \a fmts. This writes the same thing as
+ *  <tt>out.encode(to_json(from, fmts))</tt>, but without building a \c value for all of it first.
+**/
+template <typename T>
+void to_encoder(const T& from, encoder& out, const formats& fmts)
+{
+    serialization_context context(fmts);
+    event_writer writer(out);
+    context.to_encoder(from, writer);
+}
+
+/** Encode \a from straight to \a out using \c jsonv::formats::global().
+ *  
+ *  \see to_encoder(const T&, encoder&, const formats&)
+**/
+template <typename T>
+void to_encoder(const T& from, encoder& out)
+{
+    to_encoder(from, out, formats::global());
+}
+
 /** \} **/
 
 }
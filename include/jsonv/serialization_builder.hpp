@@ -16,11 +16,17 @@
 #include <jsonv/serialization.hpp>
 #include <jsonv/serialization_util.hpp>
 
+#include <algorithm>
+#include <array>
 #include <deque>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <set>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace jsonv
 {
@@ -297,6 +303,26 @@ namespace jsonv
  *  
  *  \see enum_adapter
  *  
+ *  \paragraph serialization_builder_dsl_ref_formats_level_static_type static_type
+ *  
+ *   - <tt>static_type&lt;T&gt;(static_member&lt;T, TMember, TMember T::*Selector&gt;...)</tt>
+ *  
+ *  Create an adapter for \c T from a list of members known at compile time. The result encodes and extracts the same
+ *  JSON as \ref serialization_builder_dsl_ref_formats_narrowing_type with only plain
+ *  \ref serialization_builder_dsl_ref_type_narrowing_member calls, but the members are template parameters, so the
+ *  generated code has no \c std::function or virtual call per member. The price is that none of the member-level
+ *  options (\c default_value, \c encode_if and so on) are available. The \c JSONV_STATIC_MEMBER macro makes each
+ *  member from the type, the member and its key.
+ *  
+ *  \code
+ *    .static_type<person>(JSONV_STATIC_MEMBER(person, firstname, "first_name"),
+ *                         JSONV_STATIC_MEMBER(person, lastname,  "last_name"),
+ *                         JSONV_STATIC_MEMBER(person, age,       "age")
+ *                        )
+ *  \endcode
+ *  
+ *  \see static_adapter
+ *  
  *  \paragraph serialization_builder_dls_ref_formats_level_polymorphic_type polymorphic_type
  *
  *  - <tt>polymorphic_type<&lt;TPointer&gt;(std::string discrimination_key);</tt>
@@ -381,7 +407,8 @@ namespace jsonv
  *   - <tt>pre_extract(std::function&lt;void (const extraction_context& context, const value& from)&gt; perform)</tt>
  *  
  *  Call the given \a perform function during the \c extract operation, but before performing any extraction. This can
- *  be called multiple times -- all functions will be called in the order they are provided.
+ *  be called multiple times -- all functions will be called in the order they are provided. Since \a perform is given
+ *  the whole \c value, \c extract_json decodes all of the input for this type instead of skipping unused members.
  *  
  *  \paragraph serialization_builder_dsl_ref_type_level_default_on_null type_default_on_null
  *  
@@ -507,7 +534,8 @@ namespace jsonv
  *   - <tt>default_value(std::function&lt;TMember (const extraction_context&, const value&)&gt; create)</tt>
  *  
  *  Provide a default value for this member if no key is found when extracting. You can use the function implementation
- *  to synthesize the key however you want.
+ *  to synthesize the key however you want. When used from \c extract_json, the function implementation is given the
+ *  whole object decoded into a \c value, which is not needed for the plain \a value version.
  *  
  *  \code
  *   .member("x", &my_type::x)
@@ -571,6 +599,9 @@ public:
     template <typename TEnum>
     formats_builder& enum_type_icase(std::string enum_name, std::initializer_list<std::pair<TEnum, value>> mapping);
     
+    template <typename T, typename... TMembers>
+    formats_builder& static_type(TMembers... members);
+    
     template <typename TPointer>
     polymorphic_adapter_builder<TPointer> polymorphic_type(std::string discrimination_key = "");
     
@@ -671,11 +702,34 @@ public:
     virtual ~member_adapter() noexcept
     { }
     
-    virtual void mutate(const extraction_context& context, const value& from, T& out) const = 0;
+    /** Set this member of \a out from \a found, which is the entry of the object \a from with the best of this
+     *  member's keys, or \c nullptr if \a from has none of them.
+    **/
+    virtual void mutate(const extraction_context&        context,
+                        const value&                     from,
+                        const value::object_value_type*  found,
+                        T&                               out
+                       ) const = 0;
+    
+    virtual void mutate(const extraction_context&                      context,
+                        const lazy_value&                              from,
+                        const std::pair<std::string, lazy_value>*      found,
+                        T&                                             out
+                       ) const = 0;
     
     virtual void to_json(const serialization_context& context, const T& from, value& out) const = 0;
     
-    virtual bool has_extract_key(string_view key) const = 0;
+    /** Write the key and value for this member to \a out, unless it should not be encoded.
+     *  
+     *  \returns if anything was written.
+    **/
+    virtual bool to_encoder(const serialization_context& context, const T& from, event_writer& out) const = 0;
+    
+    /** Get the key this member is encoded with. **/
+    virtual const std::string& encode_key() const = 0;
+    
+    /** Get the keys this member is extracted from, best first. **/
+    virtual const std::vector<std::string>& extract_keys() const = 0;
 };
 
 template <typename T, typename TMember>
@@ -700,21 +754,20 @@ public:
                                )
     { }
     
-    virtual void mutate(const extraction_context& context, const value& from, T& out) const override
+    virtual void mutate(const extraction_context&        context,
+                        const value&                     from,
+                        const value::object_value_type*  found,
+                        T&                               out
+                       ) const override
     {
-        value::const_object_iterator iter;
-        for (const auto& name : _names)
-            if ((iter = from.find(name)) != from.end_object())
-                break;
-        
         bool use_default = false;
-        if (iter == from.end_object())
+        if (!found)
         {
             use_default = bool(_default_value);
             if (!use_default)
                 return;
         }
-        else if (_default_on_null && iter->second.kind() == kind::null)
+        else if (_default_on_null && found->second.kind() == kind::null)
         {
             use_default = true;
         }
@@ -722,7 +775,31 @@ public:
         if (use_default)
             _set_value(out, _default_value(context, from));
         else
-            _set_value(out, context.extract_sub<TMember>(from, iter->first));
+            _set_value(out, context.extract_child<TMember>(found->second, found->first));
+    }
+    
+    virtual void mutate(const extraction_context&                      context,
+                        const lazy_value&                              from,
+                        const std::pair<std::string, lazy_value>*      found,
+                        T&                                             out
+                       ) const override
+    {
+        bool use_default = false;
+        if (!found)
+        {
+            use_default = bool(_default_value);
+            if (!use_default)
+                return;
+        }
+        else if (_default_on_null && found->second.kind() == kind::null)
+        {
+            use_default = true;
+        }
+        
+        if (use_default)
+            _set_value(out, _default_value(context, _default_needs_input ? from.to_value() : value()));
+        else
+            _set_value(out, context.extract_child<TMember>(found->second, found->first));
     }
     
     virtual void to_json(const serialization_context& context, const T& from, value& out) const override
@@ -731,9 +808,24 @@ public:
             out.insert({ _names.at(0), context.to_json(_get_value(from)) });
     }
     
-    virtual bool has_extract_key(string_view key) const override
+    virtual bool to_encoder(const serialization_context& context, const T& from, event_writer& out) const override
     {
-        return std::any_of(begin(_names), end(_names), [key] (const std::string& name) { return name == key; });
+        if (!should_encode(context, from))
+            return false;
+        
+        out.key(_names.at(0));
+        context.to_encoder(_get_value(from), out);
+        return true;
+    }
+    
+    virtual const std::string& encode_key() const override
+    {
+        return _names.at(0);
+    }
+    
+    virtual const std::vector<std::string>& extract_keys() const override
+    {
+        return _names;
     }
     
     void add_encode_check(std::function<bool (const serialization_context&, const TMember&)> check)
@@ -774,9 +866,10 @@ public:
         });
     }
     
-    void default_value(std::function<TMember (const extraction_context&, const value&)>&& create)
+    void default_value(std::function<TMember (const extraction_context&, const value&)>&& create, bool needs_input)
     {
-        _default_value = std::move(create);
+        _default_value       = std::move(create);
+        _default_needs_input = needs_input;
     }
     
     void default_on_null(bool on)
@@ -795,7 +888,7 @@ private:
     
 private:
     template <typename U, typename UMember>
-    friend class member_adapter_builder;
+    friend class jsonv::member_adapter_builder;
     
 private:
     std::vector<std::string>                                           _names;
@@ -803,6 +896,7 @@ private:
     accessor_type                                                      _get_value;
     std::function<bool (const serialization_context&, const TMember&)> _should_encode;
     std::function<TMember (const extraction_context&, const value&)>   _default_value;
+    bool                                                               _default_needs_input = true;
     bool                                                               _default_on_null = false;
     std::function<TMember (TMember&&)>                                 _extract_mutate;
 };
@@ -830,6 +924,7 @@ public:
     member_adapter_builder& alternate_name(std::string name)
     {
         _adapter->_names.emplace_back(std::move(name));
+        detail::adapter_builder_dsl<T>::owner->_adapter->index_keys();
         return *this;
     }
     
@@ -862,7 +957,7 @@ public:
     **/
     member_adapter_builder& default_value(std::function<TMember (const extraction_context&, const value&)> create)
     {
-        _adapter->default_value(std::move(create));
+        _adapter->default_value(std::move(create), true);
         return *this;
     }
     
@@ -871,7 +966,9 @@ public:
     **/
     member_adapter_builder& default_value(TMember value)
     {
-        return default_value([value] (const extraction_context&, const jsonv::value&) { return value; });
+        // the object does not need to be decoded for extract_json to call this
+        _adapter->default_value([value] (const extraction_context&, const jsonv::value&) { return value; }, false);
+        return *this;
     }
     
     /** Should a \c kind::null for a key be interpreted as a missing value? **/
@@ -980,7 +1077,7 @@ public:
                 new detail::member_adapter_impl<T, TMember>(std::move(name), selector)
             );
         member_adapter_builder<T, TMember> builder(formats_builder_dsl::owner, this, ptr.get());
-        _adapter->_members.emplace_back(std::move(ptr));
+        _adapter->add_member(std::move(ptr));
         return builder;
     }
 
@@ -995,7 +1092,7 @@ public:
                 new detail::member_adapter_impl<T, TMember>(std::move(name), std::move(mutate), std::move(access))
             );
         member_adapter_builder<T, TMember> builder(formats_builder_dsl::owner, this, ptr.get());
-        _adapter->_members.emplace_back(std::move(ptr));
+        _adapter->add_member(std::move(ptr));
         return builder;
     }
 
@@ -1058,18 +1155,9 @@ public:
         adapter_impl* adapter = _adapter;
         return pre_extract([adapter, handler] (const extraction_context& context, const value& from)
         {
-            auto is_key = [adapter] (string_view key) -> bool
-                          {
-                              return std::any_of(begin(adapter->_members), end(adapter->_members),
-                                                 [key] (const std::unique_ptr<detail::member_adapter<T>>& mem)
-                                                 {
-                                                     return mem->has_extract_key(key);
-                                                 }
-                                                );
-                          };
             std::set<std::string> extra_keys;
             for (const auto& pair : from.as_object())
-                if (!is_key(pair.first))
+                if (!adapter->is_key(pair.first))
                     extra_keys.insert(pair.first);
             if (!extra_keys.empty())
                 handler(context, from, std::move(extra_keys));
@@ -1094,11 +1182,29 @@ private:
                 return _create_default(context);
             
             T out;
-            for (const auto& member : _members)
-                member->mutate(context, from, out);
+            if (!_members.empty())
+                mutate_members(context, from, from.as_object(), out);
             return out;
         }
         
+        virtual void extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const override
+        {
+            // a pre_extract function needs the whole value, so there is nothing to skip
+            if (_pre_extract)
+                return extractor::extract_lazy(context, from, into);
+            
+            if (_default_on_null && from.kind() == kind::null)
+            {
+                new(into) T(_create_default(context));
+                return;
+            }
+            
+            T out;
+            if (!_members.empty())
+                mutate_members(context, from, from.entries(), out);
+            new(into) T(std::move(out));
+        }
+        
         virtual value to_json(const serialization_context& context, const T& from) const override
         {
             value out = object();
@@ -1107,12 +1213,108 @@ private:
             return out;
         }
         
+        virtual void to_encoder(const serialization_context& context, const T& from, event_writer& out) const override
+        {
+            out.object_begin();
+            const std::string* last_key = nullptr;
+            for (const detail::member_adapter<T>* member : _encode_order)
+            {
+                // to_json keeps the first member encoded for a key, since inserting into an object does not replace
+                if (last_key && *last_key == member->encode_key())
+                    continue;
+                if (member->to_encoder(context, from, out))
+                    last_key = &member->encode_key();
+            }
+            out.object_end();
+        }
+        
+        void add_member(std::unique_ptr<detail::member_adapter<T>> member)
+        {
+            // to_json builds an object, which keeps its keys sorted, so to_encoder writes members in the same order
+            auto position = std::upper_bound(begin(_encode_order), end(_encode_order), member.get(),
+                                             [] (const detail::member_adapter<T>* a, const detail::member_adapter<T>* b)
+                                             {
+                                                 return a->encode_key() < b->encode_key();
+                                             }
+                                            );
+            _encode_order.insert(position, member.get());
+            _members.emplace_back(std::move(member));
+            index_keys();
+        }
+        
+        /** Rebuild \c _key_index from the \c extract_keys of every member. **/
+        void index_keys()
+        {
+            _key_index.clear();
+            for (std::size_t member = 0; member < _members.size(); ++member)
+            {
+                const auto& keys = _members[member]->extract_keys();
+                for (std::size_t rank = 0; rank < keys.size(); ++rank)
+                    _key_index.push_back({ keys[rank], member, rank });
+            }
+            std::stable_sort(begin(_key_index), end(_key_index),
+                             [] (const key_target& a, const key_target& b) { return a.key < b.key; }
+                            );
+        }
+        
+        bool is_key(string_view key) const
+        {
+            auto iter = find_key(key);
+            return iter != end(_key_index) && string_view(iter->key) == key;
+        }
+        
+        /** An entry of \c _key_index, saying that \c key is the \c rank-th best key of the \c member-th member. **/
+        struct key_target
+        {
+            std::string key;
+            std::size_t member;
+            std::size_t rank;
+        };
+        
+        /** Find the first entry of \c _key_index which is not less than \a key. **/
+        typename std::vector<key_target>::const_iterator find_key(string_view key) const
+        {
+            return std::lower_bound(begin(_key_index), end(_key_index), key,
+                                    [] (const key_target& target, string_view k) { return string_view(target.key) < k; }
+                                   );
+        }
+        
+        /** Set every member of \a out from the \a entries of the object \a from. Each entry is looked up in the
+         *  \c _key_index once, instead of each member searching \a from for each of its keys.
+        **/
+        template <typename TFrom, typename TEntries>
+        void mutate_members(const extraction_context& context, const TFrom& from, const TEntries& entries, T& out) const
+        {
+            using entry_type = typename std::decay<decltype(*std::begin(entries))>::type;
+            
+            // the best entry for each member so far and the rank of its key (the first of duplicate keys is kept)
+            std::vector<std::pair<const entry_type*, std::size_t>> found(_members.size(), { nullptr, 0 });
+            for (const entry_type& entry : entries)
+            {
+                for (auto iter = find_key(entry.first); iter != end(_key_index) && iter->key == entry.first; ++iter)
+                {
+                    auto& best = found[iter->member];
+                    if (!best.first || iter->rank < best.second)
+                        best = { &entry, iter->rank };
+                }
+            }
+            
+            for (std::size_t idx = 0; idx < _members.size(); ++idx)
+                _members[idx]->mutate(context, from, found[idx].first, out);
+        }
+        
         std::deque<std::unique_ptr<detail::member_adapter<T>>>             _members;
+        std::vector<const detail::member_adapter<T>*>                      _encode_order;
+        std::vector<key_target>                                            _key_index;
         std::function<void (const extraction_context&, const value& from)> _pre_extract;
         std::function<T (const extraction_context&)>                       _create_default;
         bool                                                               _default_on_null;
     };
     
+private:
+    template <typename U, typename UMember>
+    friend class member_adapter_builder;
+    
 private:
     adapter_impl* _adapter;
 };
@@ -1202,6 +1404,171 @@ private:
     std::string                    _discrimination_key;
 };
 
+/** A member of \c T which a \c static_adapter reads and writes through \a Selector. Since the member is a template
+ *  parameter instead of something stored, every access to it can be inlined. Spelling out the types is tedious, so
+ *  these are usually made with \c JSONV_STATIC_MEMBER.
+**/
+template <typename T, typename TMember, TMember T::*Selector>
+class static_member
+{
+public:
+    using member_type = TMember;
+
+public:
+    explicit static_member(std::string name) :
+            _name(std::move(name))
+    { }
+
+    /** Get the key this member is encoded and extracted with. **/
+    const std::string& name() const
+    {
+        return _name;
+    }
+
+    /** Extract the value for this member from \a from into \a out. Like a member of an \c adapter_builder without a
+     *  \c default_value, nothing happens if \a from does not have the key.
+    **/
+    void mutate(const extraction_context& context, const value& from, T& out) const
+    {
+        auto iter = from.find(_name);
+        if (iter != from.end_object())
+            out.*Selector = context.extract_sub<TMember>(from, iter->first);
+    }
+
+    void mutate(const extraction_context& context, const lazy_value& from, T& out) const
+    {
+        if (from.find(_name))
+            out.*Selector = context.extract_sub<TMember>(from, _name);
+    }
+
+    void to_json(const serialization_context& context, const T& from, value& out) const
+    {
+        out.insert({ _name, context.to_json(from.*Selector) });
+    }
+
+    void to_encoder(const serialization_context& context, const T& from, event_writer& out) const
+    {
+        out.key(_name);
+        context.to_encoder(from.*Selector, out);
+    }
+
+private:
+    std::string _name;
+};
+
+/** Make a \c static_member for \a member_ of the class \a type_, which is encoded with the key \a name_.
+ *
+ *  \code
+ *  JSONV_STATIC_MEMBER(person, firstname, "first_name")
+ *  \endcode
+**/
+#define JSONV_STATIC_MEMBER(type_, member_, name_) \
+    ::jsonv::static_member<type_, decltype(type_::member_), &type_::member_>(name_)
+
+/** An adapter for \c T made from a list of \c static_member. This does the same thing as an \c adapter_builder which
+ *  only has plain \c member calls, but the list of members is known at compile time, so the member loops are unrolled
+ *  and nothing goes through a \c std::function or a virtual call per member. Make one with
+ *  \c formats_builder::static_type.
+**/
+template <typename T, typename... TMembers>
+class static_adapter :
+        public adapter_for<T>
+{
+public:
+    explicit static_adapter(TMembers... members) :
+            _members(std::move(members)...)
+    {
+        build_encode_order(std::index_sequence_for<TMembers...>());
+    }
+
+    virtual void extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const override
+    {
+        T out;
+        mutate_all(context, from, out, std::index_sequence_for<TMembers...>());
+        new(into) T(std::move(out));
+    }
+
+protected:
+    virtual T create(const extraction_context& context, const value& from) const override
+    {
+        T out;
+        mutate_all(context, from, out, std::index_sequence_for<TMembers...>());
+        return out;
+    }
+
+    virtual value to_json(const serialization_context& context, const T& from) const override
+    {
+        value out = object();
+        to_json_all(context, from, out, std::index_sequence_for<TMembers...>());
+        return out;
+    }
+
+    virtual void to_encoder(const serialization_context& context, const T& from, event_writer& out) const override
+    {
+        out.object_begin();
+        to_encoder_all(context, from, out, std::index_sequence_for<TMembers...>());
+        out.object_end();
+    }
+
+private:
+    using encode_function = void (*)(const static_adapter&, const serialization_context&, const T&, event_writer&);
+
+    template <typename TFrom, std::size_t... Index>
+    void mutate_all(const extraction_context& context, const TFrom& from, T& out, std::index_sequence<Index...>) const
+    {
+        using expand = int[];
+        (void) expand { 0, (std::get<Index>(_members).mutate(context, from, out), 0)... };
+    }
+
+    template <std::size_t... Index>
+    void to_json_all(const serialization_context& context, const T& from, value& out, std::index_sequence<Index...>) const
+    {
+        using expand = int[];
+        (void) expand { 0, (std::get<Index>(_members).to_json(context, from, out), 0)... };
+    }
+
+    template <std::size_t... Index>
+    void to_encoder_all(const serialization_context& context,
+                        const T&                     from,
+                        event_writer&                out,
+                        std::index_sequence<Index...>
+                       ) const
+    {
+        static const std::array<encode_function, sizeof...(Index)> encoders = {{ &encode_member<Index>... }};
+        for (std::size_t idx : _encode_order)
+            encoders[idx](*this, context, from, out);
+    }
+
+    template <std::size_t Index>
+    static void encode_member(const static_adapter&        self,
+                              const serialization_context& context,
+                              const T&                     from,
+                              event_writer&                out
+                             )
+    {
+        std::get<Index>(self._members).to_encoder(context, from, out);
+    }
+
+    template <std::size_t... Index>
+    void build_encode_order(std::index_sequence<Index...>)
+    {
+        // to_json builds an object, which keeps its keys sorted and keeps the first member inserted for a key
+        const std::array<const std::string*, sizeof...(Index)> names = {{ &std::get<Index>(_members).name()... }};
+        auto by_name = [&names] (std::size_t a, std::size_t b) { return *names[a] < *names[b]; };
+        for (std::size_t idx = 0; idx < names.size(); ++idx)
+        {
+            auto position = std::upper_bound(begin(_encode_order), end(_encode_order), idx, by_name);
+            if (position != begin(_encode_order) && *names[*std::prev(position)] == *names[idx])
+                continue;
+            _encode_order.insert(position, idx);
+        }
+    }
+
+private:
+    std::tuple<TMembers...>  _members;
+    std::vector<std::size_t> _encode_order;
+};
+
 class JSONV_PUBLIC formats_builder
 {
 public:
@@ -1235,6 +1602,19 @@ public:
         return register_adapter(std::make_shared<enum_adapter_icase<TEnum>>(std::move(enum_name), mapping));
     }
     
+    template <typename T, typename... TMembers>
+    formats_builder& static_type(TMembers... members)
+    {
+        using expand = int[];
+        (void) expand { 0, (reference_type(std::type_index(typeid(typename TMembers::member_type)),
+                                           std::type_index(typeid(T))
+                                          ),
+                            0
+                           )...
+                      };
+        return register_adapter(std::make_shared<static_adapter<T, TMembers...>>(std::move(members)...));
+    }
+    
     template <typename TPointer>
     polymorphic_adapter_builder<TPointer>
     polymorphic_type(std::string discrimination_key = "")
@@ -1385,6 +1765,12 @@ formats_builder& formats_builder_dsl::enum_type_icase(std::string
     return owner->enum_type_icase<TEnum>(std::move(enum_name), mapping);
 }
 
+template <typename T, typename... TMembers>
+formats_builder& formats_builder_dsl::static_type(TMembers... members)
+{
+    return owner->static_type<T>(std::move(members)...);
+}
+
 template <typename TPointer>
 polymorphic_adapter_builder<TPointer>
 formats_builder_dsl::polymorphic_type(std::string discrimination_key)
@@ -166,10 +166,23 @@ public:
         return to_json(context, *static_cast<const T*>(from));
     }
     
+    virtual void to_encoder(const serialization_context& context,
+                            const void*                  from,
+                            event_writer&                out
+                           ) const override
+    {
+        to_encoder(context, *static_cast<const T*>(from), out);
+    }
+    
 protected:
     virtual value to_json(const serialization_context& context,
                           const T&                     from
                          ) const = 0;
+    
+    virtual void to_encoder(const serialization_context& context, const T& from, event_writer& out) const
+    {
+        out.value(to_json(context, from));
+    }
 };
 
 template <typename T, typename FToJson>
@@ -239,10 +252,23 @@ public:
         return to_json(context, *static_cast<const T*>(from));
     }
     
+    virtual void to_encoder(const serialization_context& context,
+                            const void*                  from,
+                            event_writer&                out
+                           ) const override
+    {
+        to_encoder(context, *static_cast<const T*>(from), out);
+    }
+    
 protected:
     virtual T create(const extraction_context& context, const value& from) const = 0;
     
     virtual value to_json(const serialization_context& context, const T& from) const = 0;
+    
+    virtual void to_encoder(const serialization_context& context, const T& from, event_writer& out) const
+    {
+        out.value(to_json(context, from));
+    }
 };
 
 template <typename T, typename FExtract, typename FToJson>
@@ -353,6 +379,14 @@ protected:
             return TOptional(context.extract<element_type>(from));
     }
 
+    virtual void extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const override
+    {
+        if (from.kind() == kind::null)
+            new(into) TOptional();
+        else
+            new(into) TOptional(context.extract<element_type>(from));
+    }
+
     virtual value to_json(const serialization_context& context, const TOptional& from) const override
     {
         if (from)
@@ -360,6 +394,17 @@ protected:
         else
             return value();
     }
+
+    virtual void to_encoder(const serialization_context& context,
+                            const TOptional&             from,
+                            event_writer&                out
+                           ) const override
+    {
+        if (from)
+            context.to_encoder(*from, out);
+        else
+            out.null();
+    }
 };
 
 /** An adapter for container types. This is for convenience of creating an \c adapter for things like \c std::vector,
@@ -386,6 +431,15 @@ protected:
         return out;
     }
     
+    virtual void extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const override
+    {
+        using std::end;
+        
+        TContainer out;
+        context.extract_elements<element_type>(from, [&out] (element_type&& x) { out.insert(end(out), std::move(x)); });
+        new(into) TContainer(std::move(out));
+    }
+    
     virtual value to_json(const serialization_context& context, const TContainer& from) const override
     {
         value out = array();
@@ -393,6 +447,17 @@ protected:
             out.push_back(context.to_json(x));
         return out;
     }
+    
+    virtual void to_encoder(const serialization_context& context,
+                            const TContainer&            from,
+                            event_writer&                out
+                           ) const override
+    {
+        out.array_begin();
+        for (const element_type& x : from)
+            context.to_encoder(x, out);
+        out.array_end();
+    }
 };
 
 /** An adapter for "wrapper" types.
@@ -412,10 +477,23 @@ protected:
         return TWrapper(context.extract<element_type>(from));
     }
 
+    virtual void extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const override
+    {
+        new(into) TWrapper(context.extract<element_type>(from));
+    }
+
     virtual value to_json(const serialization_context& context, const TWrapper& from) const override
     {
         return context.to_json(element_type(from));
     }
+
+    virtual void to_encoder(const serialization_context& context,
+                            const TWrapper&              from,
+                            event_writer&                out
+                           ) const override
+    {
+        context.to_encoder(element_type(from), out);
+    }
 };
 
 /** An adapter for enumeration types. The most common use of this is to map \c enum values in C++ to string values in a
@@ -505,6 +583,17 @@ protected:
             return null;
     }
     
+    virtual void to_encoder(const serialization_context&, const TEnum& from, event_writer& out) const override
+    {
+        using std::end;
+        
+        auto iter = _cpp_to_val.find(from);
+        if (iter != end(_cpp_to_val))
+            out.value(iter->second);
+        else
+            out.null();
+    }
+    
 private:
     std::string                        _enum_name;
     std::map<value, TEnum, FValueComp> _val_to_cpp;
@@ -18,6 +18,7 @@
 
 #include <iosfwd>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace jsonv
@@ -101,12 +102,15 @@ class JSONV_PUBLIC tokenizer
 public:
     using size_type = std::vector<char>::size_type;
     
-    /// \deprecated
-    /// See \ref buffer_reserve.
+    /** Get the minimum number of bytes a \c tokenizer constructed from an \c std::istream will attempt to read from it
+     *  when it needs more data. The default value is <tt>1024 * sizeof(void*)</tt>.
+    **/
     static size_type min_buffer_size();
     
-    /// \deprecated
-    /// See \ref buffer_reserve.
+    /** Set the minimum number of bytes a \c tokenizer constructed from an \c std::istream will attempt to read from it
+     *  when it needs more data. The value will be set to at least 1. This only affects \c tokenizer instances
+     *  constructed after this call.
+    **/
     static void set_min_buffer_size(size_type sz);
     
     /** A representation of what this tokenizer has. **/
@@ -125,12 +129,26 @@ public:
     /// Construct a tokenizer to read the given non-owned \a input.
     explicit tokenizer(string_view input);
 
-    /// Construct a tokenizer from the provided \a input.
+    /** Construct a tokenizer to read the given \a input, which is owned by \a owner (such as the memory mapping of a
+     *  file). This instance shares ownership of \a owner, so \a input and the text of every token stay valid for as
+     *  long as this instance does.
+    **/
+    tokenizer(string_view input, std::shared_ptr<const void> owner);
+
+    /** Construct a tokenizer which incrementally reads from the provided \a input. Data is read from \a input in chunks
+     *  of at least \c min_buffer_size bytes as tokens are consumed, so the entire stream is never held in memory at
+     *  once (unless it consists of a single enormous token). The \a input must outlive this instance.
+    **/
     explicit tokenizer(std::istream& input);
     
+    tokenizer(const tokenizer&) = delete;
+    tokenizer& operator=(const tokenizer&) = delete;
+    
     ~tokenizer() noexcept;
     
-    /// Get the input this instance is reading from.
+    /** Get the input this instance is reading from. If this instance was constructed from an \c std::istream, this is
+     *  only the window of the stream which is currently buffered and it is invalidated by a call to \c next.
+    **/
     const string_view& input() const;
     
     /** Attempt to go to the next token in the input stream. The contents of \c current will be cleared.
@@ -140,25 +158,36 @@ public:
     **/
     bool next();
     
-    /** Get the current token and its associated \c token_kind.
+    /** Get the current token and its associated \c token_kind. The \c token::text refers to memory owned by the input
+     *  or this instance, so it should be copied if it is needed after the next call to \c next.
      *  
      *  \returns The current token.
      *  \throws std::logic_error if \c next has not been called or if it returned \c false.
     **/
     const token& current() const;
     
-    /// \deprecated
-    /// Calling this function has no effect and will be removed in 2.0.
+    /** Ensure the internal buffer of a \c tokenizer constructed from an \c std::istream can hold at least \a sz bytes.
+     *  Subsequent reads from the stream will attempt to fill the buffer to this capacity. This has no effect on a
+     *  \c tokenizer constructed from a \c string_view.
+    **/
     void buffer_reserve(size_type sz);
     
 private:
-    explicit tokenizer(std::shared_ptr<std::string> input);
+    /** Discard all consumed input (except for the current token) and read more data from \c _source.
+     *  
+     *  \returns \c true if more data was read; \c false if the source is exhausted (or there is no source).
+    **/
+    bool refill();
     
 private:
     string_view           _input;
     const char*           _position;
     token                 _current;  //!< The current token
-    std::shared_ptr<void> _track;    //!< Used to track input data when needed (\c std::istream constructor)
+    std::istream*         _source;   //!< The stream to read more data from (\c nullptr when there is no more data)
+    std::string*          _buffer;   //!< The buffer \c _input refers to when reading from \c _source (owned by \c _track)
+    
+    /** Keeps the input data alive when needed. **/
+    std::shared_ptr<const void> _track;
 };
 
 }
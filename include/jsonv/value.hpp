@@ -12,6 +12,7 @@
 #define __JSONV_VALUE_HPP_INCLUDED__
 
 #include <jsonv/config.hpp>
+#include <jsonv/memory_resource.hpp>
 #include <jsonv/string_view.hpp>
 #include <jsonv/detail/basic_view.hpp>
 
@@ -41,6 +42,15 @@ class object_impl;
 class array_impl;
 class string_impl;
 
+/** Create a string, array or object value whose storage comes from \a resource. These are how \c parse builds trees
+ *  for \c parse_options::resource. A string made by \c borrow_string refers to the characters of \a source instead of
+ *  copying them (see \c parse_options::borrow_input).
+**/
+JSONV_LOCAL value make_string(std::string&& source, memory_resource* resource);
+JSONV_LOCAL value borrow_string(string_view source, memory_resource* resource);
+JSONV_LOCAL value make_array(memory_resource* resource);
+JSONV_LOCAL value make_object(memory_resource* resource);
+
 union value_storage
 {
     object_impl* object;
@@ -117,13 +127,17 @@ public:
  *     the cases where it makes sense (for example: \c empty and \c size), but in general, string manipulation should be
  *     done after calling \c as_string.
  *   - \c kind::array
- *     An array behaves like a \c std::deque because it is ultimately backed by one. If you feel the documentation is
- *     lacking, read this: http://en.cppreference.com/w/cpp/container/deque.
+ *     An array behaves like a \c std::vector because it is ultimately backed by one. If you feel the documentation is
+ *     lacking, read this: http://en.cppreference.com/w/cpp/container/vector. The elements are contiguous in memory,
+ *     which makes iteration fast, but adding or removing an element anywhere but the back is linear in the size of the
+ *     array, and adding an element can invalidate references to the other elements.
  *   - \c kind::object
  *     An object behaves lake a \c std::map because it is ultimately backed by one. If you feel the documentation is
  *     lacking, read this: http://en.cppreference.com/w/cpp/container/map. This library follows the recommendation in
  *     RFC 7159 to not allow for duplicate keys because most other libraries can not deal with it. It would also make
- *     the AST significantly more painful.
+ *     the AST significantly more painful. If the library is built with \c JSONV_OBJECT_USE_FLAT_MAP, objects are
+ *     backed by a sorted vector instead, so inserting or erasing a key invalidates all iterators and references into
+ *     that object.
  *  
  *  \see http://json.org/
  *  \see http://tools.ietf.org/html/rfc7159
@@ -403,8 +417,15 @@ public:
     /** The \c object_iterator is applicable when \c kind is \c kind::object. It allows you to use algorithms as if
      *  a \c value was a normal associative container.
     **/
-    typedef basic_object_iterator<object_value_type,       std::map<std::string, value>::iterator>       object_iterator;
-    typedef basic_object_iterator<const object_value_type, std::map<std::string, value>::const_iterator> const_object_iterator;
+#if JSONV_OBJECT_USE_FLAT_MAP
+    typedef basic_object_iterator<object_value_type,       object_value_type*>                           object_iterator;
+    typedef basic_object_iterator<const object_value_type, const object_value_type*>                     const_object_iterator;
+#else
+    typedef std::map<std::string, value, std::less<std::string>, detail::resource_allocator<object_value_type>>
+            object_map_type;
+    typedef basic_object_iterator<object_value_type,       object_map_type::iterator>                    object_iterator;
+    typedef basic_object_iterator<const object_value_type, object_map_type::const_iterator>              const_object_iterator;
+#endif
     
     /** If \c kind is \c kind::object, an \c object_view allows you to access a value as an associative container.
      *  This is most useful for range-based for loops.
@@ -441,6 +462,9 @@ public:
     
     /** Create a \c kind::string with the given \a value. **/
     value(const std::string& value);
+    
+    /** Create a \c kind::string by taking the contents of \a value. **/
+    value(std::string&& value);
 
     /** Create a \c kind::string with the given \a value. **/
     value(const string_view& value);
@@ -506,6 +530,7 @@ public:
     bool is_string() const;
 
     /** Get this value as a \c string_view. It is your responsibility to ensure the \c value instance remains valid.
+     *  Unlike \c as_string, this never needs to copy a string which was parsed with \c parse_options::borrow_input.
      *
      *  \throws kind_error if this value does not represent a string.
     **/
@@ -712,13 +737,14 @@ public:
     **/
     void pop_back();
     
-    /** Push \a item to the front of this array.
+    /** Push \a item to the front of this array. This moves every other element of the array, so prefer \c push_back
+     *  when building large arrays.
      *  
      *  \throws kind_error if the kind is not an array.
     **/
     void push_front(value item);
     
-    /** Pop an item from the front of this array.
+    /** Pop an item from the front of this array. Like \c push_front, this moves every other element of the array.
      *  
      *  \throws kind_error if the kind is not an array.
      *  \throws std::logic_error if the array is empty.
@@ -986,6 +1012,10 @@ public:
 private:
     friend JSONV_PUBLIC value array();
     friend JSONV_PUBLIC value object();
+    friend value detail::make_string(std::string&&, memory_resource*);
+    friend value detail::borrow_string(string_view, memory_resource*);
+    friend value detail::make_array(memory_resource*);
+    friend value detail::make_object(memory_resource*);
     
 private:
     detail::value_storage _data;
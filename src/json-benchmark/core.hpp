@@ -41,6 +41,18 @@ public:
     
     virtual value_ptr create_value(const std::string& source) const = 0;
     
+    /** Look up every key of every object in a value created by \c create_value.
+     *  
+     *  \returns \c false if this suite does not support the test.
+    **/
+    virtual bool lookup_test(const value_ptr&) const { return false; }
+    
+    /** Visit every element of every array and object in a value created by \c create_value.
+     *  
+     *  \returns \c false if this suite does not support the test.
+    **/
+    virtual bool iterate_test(const value_ptr&) const { return false; }
+    
 private:
     std::string _name;
 };
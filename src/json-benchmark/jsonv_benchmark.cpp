@@ -15,16 +15,58 @@
 namespace json_benchmark
 {
 
+static std::size_t lookup_all(const jsonv::value& x)
+{
+    std::size_t found = 0;
+    if (x.kind() == jsonv::kind::object)
+    {
+        for (const auto& entry : x.as_object())
+            found += x.count(entry.first) + lookup_all(entry.second);
+    }
+    else if (x.kind() == jsonv::kind::array)
+    {
+        for (const auto& sub : x.as_array())
+            found += lookup_all(sub);
+    }
+    return found;
+}
+
+static std::size_t count_all(const jsonv::value& x)
+{
+    std::size_t visited = 1;
+    if (x.kind() == jsonv::kind::object)
+    {
+        for (const auto& entry : x.as_object())
+            visited += count_all(entry.second);
+    }
+    else if (x.kind() == jsonv::kind::array)
+    {
+        for (const auto& sub : x.as_array())
+            visited += count_all(sub);
+    }
+    return visited;
+}
+
 class jsonv_benchmark_suite :
         public typed_benchmark_suite<jsonv::value>
 {
 public:
     jsonv_benchmark_suite() :
-            typed_benchmark_suite<jsonv::value>("JSONV")
+            typed_benchmark_suite<jsonv::value>(JSONV_OBJECT_USE_FLAT_MAP ? "JSONV-flat" : "JSONV")
     { }
     
+    virtual bool lookup_test(const value_ptr& source) const override
+    {
+        return lookup_all(*static_cast<const jsonv::value*>(source.get())) > 0;
+    }
+    
+    virtual bool iterate_test(const value_ptr& source) const override
+    {
+        return count_all(*static_cast<const jsonv::value*>(source.get())) > 0;
+    }
+    
 protected:
-    virtual jsonv::value parse(const std::string& source) const
+    virtual jsonv::value parse(const std::string& source) const override
     {
         return jsonv::parse(source);
     }
@@ -196,6 +196,26 @@ static std::string get_encoded_json()
     return encoded;
 }
 
+/** Time a test over an already-created value. Suites which do not support the test print nothing. **/
+template <typename FTest>
+static void run_value_test(const json_benchmark::benchmark_suite& suite,
+                           const char*                            test_name,
+                           int                                    loop_count,
+                           FTest                                  test
+                          )
+{
+    stopwatch watch;
+    for (int idx = 1; idx <= loop_count; ++idx)
+    {
+        auto ticker = watch.start();
+        if (!test())
+            return;
+    }
+    
+    auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time) / watch.tick_count;
+    std::cout << std::endl << suite.name() << ' ' << test_name << '\t' << average.count();
+}
+
 int main(int argc, char** argv)
 {
     using namespace json_benchmark;
@@ -228,5 +248,9 @@ int main(int argc, char** argv)
         
         auto average = std::chrono::duration_cast<std::chrono::duration<double>>(watch.total_time) / watch.tick_count;
         std::cout << suite->name() << '\t' << average.count();// << std::endl;
+        
+        auto value = suite->create_value(encoded);
+        run_value_test(*suite, "lookup",  loop_count, [&] { return suite->lookup_test(value); });
+        run_value_test(*suite, "iterate", loop_count, [&] { return suite->iterate_test(value); });
     }
 }
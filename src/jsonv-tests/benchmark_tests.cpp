@@ -66,6 +66,63 @@ private:
     std::string path;
 };
 
+/** Time \c parse_file, which memory-maps the file instead of reading it through a stream or into a string. Unlike the
+ *  other loaders, opening the file is part of the timing, since it is part of the call.
+**/
+class parse_file_benchmark_test :
+        public unit_test
+{
+public:
+    explicit parse_file_benchmark_test(std::string path) :
+            unit_test(std::string("benchmark/mmap/") + filename(path)),
+            path(std::move(path))
+    { }
+
+    virtual void run_impl() override
+    {
+        stopwatch timer;
+        for (unsigned cnt = 0; cnt < iterations; ++cnt)
+        {
+            JSONV_TEST_TIME(timer);
+            parse_file(path);
+        }
+        std::cout << timer.get();
+    }
+
+private:
+    std::string path;
+};
+
+/** Time encoding the parsed contents of a file, which is dominated by formatting numbers for files like
+ *  \c canada.json.
+**/
+class encode_benchmark_test :
+        public unit_test
+{
+public:
+    explicit encode_benchmark_test(std::string path) :
+            unit_test(std::string("benchmark/encode/") + filename(path)),
+            path(std::move(path))
+    { }
+
+    virtual void run_impl() override
+    {
+        std::ifstream file(path.c_str());
+        value src_data = parse(file);
+
+        stopwatch timer;
+        for (unsigned cnt = 0; cnt < iterations; ++cnt)
+        {
+            JSONV_TEST_TIME(timer);
+            to_string(src_data);
+        }
+        std::cout << timer.get();
+    }
+
+private:
+    std::string path;
+};
+
 class benchmark_test_initializer
 {
 public:
@@ -75,6 +132,8 @@ public:
         {
             _tests.emplace_back(new benchmark_test<std::ifstream>([] (const std::string& p) { return p; }, "ifstream", path));
             _tests.emplace_back(new benchmark_test<std::string>(load_from_file, "string", path));
+            _tests.emplace_back(new parse_file_benchmark_test(path));
+            _tests.emplace_back(new encode_benchmark_test(path));
         });
     }
 
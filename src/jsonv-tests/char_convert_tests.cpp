@@ -12,7 +12,9 @@
 
 #include <jsonv/char_convert.hpp>
 
+#include <random>
 #include <sstream>
+#include <utility>
 
 using jsonv::detail::decode_error;
 
@@ -270,3 +272,58 @@ TEST(string_decode_invalid_utf8_start)
 {
     ensure_throws(decode_error, string_decode_static("\xfe is not a UTF-8 start"));
 }
+
+TEST(string_decode_unterminated_utf8_sequence)
+{
+    ensure_throws(decode_error, string_decode_static("ends early \xe2\x98"));
+    ensure_eq(std::string("ends early \xe2\x98"),
+              string_decode_static("ends early \xe2\x98", jsonv::parse_options::encoding::cesu8)
+             );
+}
+
+TEST(string_decode_strict_unprintable)
+{
+    ensure_eq("a\tb", string_decode_static("a\tb"));
+    ensure_throws(decode_error, string_decode_static("a long run of text before the \t tab",
+                                                     jsonv::parse_options::encoding::utf8_strict
+                                                    )
+                 );
+    ensure_throws(decode_error, string_decode_static("\x7f", jsonv::parse_options::encoding::utf8_strict));
+}
+
+TEST(string_decode_random_mix)
+{
+    // pieces of encoded text and what they decode to -- long plain runs are mixed with everything that needs a closer
+    // look so the fast path starts and stops at every alignment
+    static const std::pair<std::string, std::string> pieces[] =
+    {
+        { "the quick brown fox jumps over the lazy dog",
+          "the quick brown fox jumps over the lazy dog"
+        },
+        { "x",                "x" },
+        { "\\n",              "\n" },
+        { "\\\\",             "\\" },
+        { "\\/",              "/" },
+        { "\\u00e9",          "\xc3\xa9" },
+        { "\\ud83d\\ude00",   "\xf0\x9f\x98\x80" },
+        { "\xc3\xa9",         "\xc3\xa9" },
+        { "\xe2\x98\xa2",     "\xe2\x98\xa2" },
+        { "\xf0\x9f\x98\x80", "\xf0\x9f\x98\x80" },
+    };
+
+    auto decoder = jsonv::detail::get_string_decoder(jsonv::parse_options::encoding::utf8);
+    std::mt19937 rng(24680);
+    for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+    {
+        std::string encoded;
+        std::string expected;
+        std::size_t count = rng() % 20;
+        for (std::size_t idx = 0; idx < count; ++idx)
+        {
+            const auto& piece = pieces[rng() % (sizeof pieces / sizeof pieces[0])];
+            encoded  += piece.first;
+            expected += piece.second;
+        }
+        ensure_eq(expected, decoder(encoded));
+    }
+}
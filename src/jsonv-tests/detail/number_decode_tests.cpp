@@ -0,0 +1,182 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/number_decode.hpp>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+using namespace jsonv::detail;
+
+/** What \c decode_number did before it had its own parser, minus wrapping around on integer overflow. **/
+static kind reference_decode(const std::string& text, std::int64_t& integer, double& decimal)
+{
+    char* end = nullptr;
+    if (text.find_first_of(".Ee") == std::string::npos)
+    {
+        errno = 0;
+        if (text[0] == '-')
+        {
+            auto val = std::strtoll(text.c_str(), &end, 10);
+            if (errno == 0)
+            {
+                integer = val;
+                return kind::integer;
+            }
+        }
+        else
+        {
+            auto val = std::strtoull(text.c_str(), &end, 10);
+            if (errno == 0)
+            {
+                integer = std::int64_t(val);
+                return kind::integer;
+            }
+        }
+    }
+
+    decimal = std::strtod(text.c_str(), &end);
+    return kind::decimal;
+}
+
+static void check_decode(const std::string& text)
+{
+    std::int64_t expected_integer = 0, actual_integer = 0;
+    double       expected_decimal = 0, actual_decimal = 0;
+    kind expected_kind = reference_decode(text, expected_integer, expected_decimal);
+    kind actual_kind   = decode_number(text, actual_integer, actual_decimal);
+
+    if (expected_kind != actual_kind)
+        throw std::runtime_error("Wrong kind for \"" + text + "\": " + to_string(actual_kind));
+
+    if (expected_kind == kind::integer && expected_integer != actual_integer)
+        throw std::runtime_error("Wrong value for \"" + text + "\": " + std::to_string(actual_integer));
+
+    if (expected_kind == kind::decimal && std::memcmp(&expected_decimal, &actual_decimal, sizeof(double)) != 0)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof buffer, "%.17g (expected %.17g)", actual_decimal, expected_decimal);
+        throw std::runtime_error("Wrong value for \"" + text + "\": " + buffer);
+    }
+}
+
+TEST(number_decode_integers)
+{
+    for (const char* text : { "0", "-0", "1", "-1", "007", "-007", "42", "123456789", "12345678901234567",
+                              "9223372036854775807", "-9223372036854775807", "-9223372036854775808",
+                              "9223372036854775808", "18446744073709551615", "00000000000000000000000000001",
+                              "9999999999999999999", "-9999999999999999999"
+                            }
+        )
+        check_decode(text);
+}
+
+TEST(number_decode_integer_overflow_is_decimal)
+{
+    for (const char* text : { "18446744073709551616", "-9223372036854775809", "99999999999999999999999999",
+                              "-123456789012345678901234567890"
+                            }
+        )
+        check_decode(text);
+
+    std::int64_t integer;
+    double       decimal;
+    ensure(kind::decimal == decode_number("18446744073709551616", integer, decimal));
+    ensure_eq(18446744073709551616.0, decimal);
+}
+
+TEST(number_decode_decimals)
+{
+    for (const char* text : { "0.0", "-0.0", "0e0", "1.5", "-1.5", "0.1", "0.2", "0.3", "1e22", "1e23", "9007199254740993",
+                              "9007199254740993.0", "3.141592653589793", "2.2250738585072014e-308",
+                              "2.2250738585072011e-308", "4.9406564584124654e-324", "2.4703282292062327e-324",
+                              "2.4703282292062328e-324", "1.7976931348623157e308", "1.7976931348623158e308",
+                              "1.7976931348623159e308", "1e309", "-1e309", "1e-400", "1E+2", "1e-2", "123.456e-7",
+                              "0.000000000000000000000000000000000000001", "1e0000000000000000000000000000000000001",
+                              "1e-99999999999999999999", "1e99999999999999999999",
+                              "7.2057594037927933e16", "9.109e-31", "6.02214076e23",
+                              "1.00000000000000011102230246251565404236316680908203125",
+                              "1.00000000000000011102230246251565404236316680908203124",
+                              "1.00000000000000011102230246251565404236316680908203126",
+                              "9007199254740992.9999999999999999999999",
+                              "123456789012345678901234567890.123456789e-10",
+                              "0.0000000000000000000000000000000012345678901234567890123e10"
+                            }
+        )
+        check_decode(text);
+}
+
+TEST(number_decode_invalid)
+{
+    std::int64_t integer;
+    double       decimal;
+    for (const char* text : { "", "-", "1.", ".5", "1e", "1e+", "--1", "1.2.3", "1x", "0x10", "+1", "1e5.5" })
+        ensure(kind::null == decode_number(text, integer, decimal));
+}
+
+TEST(number_decode_random_doubles)
+{
+    std::mt19937_64 rng(8675309);
+    char buffer[64];
+    for (int idx = 0; idx < 200000; ++idx)
+    {
+        std::uint64_t bits = rng();
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        if (!std::isfinite(value))
+            continue;
+
+        std::snprintf(buffer, sizeof buffer, "%.17g", value);
+        check_decode(buffer);
+        std::snprintf(buffer, sizeof buffer, "%.*e", int(rng() % 17), value);
+        check_decode(buffer);
+    }
+}
+
+TEST(number_decode_random_digits)
+{
+    std::mt19937_64 rng(5551212);
+    for (int idx = 0; idx < 200000; ++idx)
+    {
+        std::string text;
+        if (rng() % 2)
+            text += '-';
+        std::size_t int_digits = 1 + rng() % 25;
+        for (std::size_t digit = 0; digit < int_digits; ++digit)
+            text += char('0' + rng() % 10);
+        if (rng() % 2)
+        {
+            text += '.';
+            std::size_t frac_digits = 1 + rng() % 25;
+            for (std::size_t digit = 0; digit < frac_digits; ++digit)
+                text += char('0' + rng() % 10);
+        }
+        if (rng() % 2)
+        {
+            text += "e";
+            text += std::to_string(int(rng() % 700) - 350);
+        }
+        check_decode(text);
+    }
+}
+
+}
@@ -0,0 +1,166 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/number_decode.hpp>
+#include <jsonv/detail/number_encode.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+using namespace jsonv::detail;
+
+static std::string format(double value)
+{
+    char buffer[format_decimal_max_length];
+    return std::string(buffer, format_decimal(value, buffer));
+}
+
+/** The fewest significant digits \c printf needs for \a value to read back the same. **/
+static std::size_t printf_digits(double value)
+{
+    char buffer[64];
+    for (int precision = 1; precision < 17; ++precision)
+    {
+        std::snprintf(buffer, sizeof buffer, "%.*e", precision - 1, value);
+        if (std::strtod(buffer, nullptr) == value)
+            return std::size_t(precision);
+    }
+    return 17U;
+}
+
+static std::size_t significant_digits(const std::string& text)
+{
+    std::size_t count = 0;
+    bool leading = true;
+    for (char c : text)
+    {
+        if (c == 'e')
+            break;
+        if (c < '0' || c > '9' || (leading && c == '0'))
+            continue;
+        leading = false;
+        ++count;
+    }
+    // trailing zeros of integers are placeholders, not significant digits
+    if (text.find_first_of(".e") == std::string::npos)
+        for (auto iter = text.rbegin(); iter != text.rend() && *iter == '0' && count > 1; ++iter)
+            --count;
+    return count;
+}
+
+/** \a value must be formatted with the fewest possible digits and read back as exactly \a value. **/
+static void check_round_trip(double value)
+{
+    std::string text = format(value);
+
+    std::int64_t integer = 0;
+    double       decimal = 0;
+    kind decoded_kind = decode_number(text, integer, decimal);
+    if (decoded_kind == kind::integer)
+        decimal = double(integer);
+    if (decoded_kind == kind::null || std::memcmp(&value, &decimal, sizeof value) != 0)
+    {
+        // -0 comes back as the integer 0
+        if (!(value == 0.0 && text == "-0"))
+            throw std::runtime_error("\"" + text + "\" does not read back as the value it was formatted from");
+    }
+
+    if (value != 0.0 && significant_digits(text) > printf_digits(value))
+        throw std::runtime_error("\"" + text + "\" has more digits than needed");
+}
+
+TEST(format_decimal_layout)
+{
+    ensure_eq("0",                       format(0.0));
+    ensure_eq("-0",                      format(-0.0));
+    ensure_eq("1",                       format(1.0));
+    ensure_eq("-1.5",                    format(-1.5));
+    ensure_eq("0.1",                     format(0.1));
+    ensure_eq("0.30000000000000004",     format(0.1 + 0.2));
+    ensure_eq("3.141592653589793",       format(3.141592653589793));
+    ensure_eq("1000000",                 format(1e6));
+    ensure_eq("10000000000000000",       format(1e16));
+    ensure_eq("1e+17",                   format(1e17));
+    ensure_eq("1.2345e+20",              format(1.2345e20));
+    ensure_eq("0.0001",                  format(1e-4));
+    ensure_eq("1e-05",                   format(1e-5));
+    ensure_eq("-2.5e-10",                format(-2.5e-10));
+    ensure_eq("1e+100",                  format(1e100));
+    ensure_eq("9007199254740992",        format(9007199254740992.0));
+    ensure_eq("1.7976931348623157e+308", format(std::numeric_limits<double>::max()));
+    ensure_eq("2.2250738585072014e-308", format(std::numeric_limits<double>::min()));
+    ensure_eq("5e-324",                  format(std::numeric_limits<double>::denorm_min()));
+}
+
+TEST(format_decimal_round_trip_edges)
+{
+    for (double value : { 0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0, 123.456, 1e22, 1e23, 5e-324, 1e-323,
+                          2.2250738585072009e-308, 2.2250738585072014e-308, 1.7976931348623157e308,
+                          9007199254740993.0, 18446744073709551616.0, 4.35, 8.41, 5e-310, 299792458.0,
+                          std::nextafter(1.0, 2.0), std::nextafter(1.0, 0.0)
+                        }
+        )
+    {
+        check_round_trip(value);
+        check_round_trip(-value);
+    }
+
+    for (int exponent = -323; exponent <= 308; ++exponent)
+    {
+        double power = std::strtod(("1e" + std::to_string(exponent)).c_str(), nullptr);
+        check_round_trip(power);
+        check_round_trip(std::nextafter(power, 0.0));
+        check_round_trip(std::nextafter(power, HUGE_VAL));
+    }
+
+    for (int exponent = -1074; exponent <= 1023; ++exponent)
+        check_round_trip(std::ldexp(1.0, exponent));
+}
+
+TEST(format_decimal_round_trip_random)
+{
+    std::mt19937_64 rng(1234567);
+    for (int idx = 0; idx < 200000; ++idx)
+    {
+        std::uint64_t bits = rng();
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        if (std::isfinite(value))
+            check_round_trip(value);
+    }
+
+    // values people actually write, like coordinates and prices
+    for (int idx = 0; idx < 100000; ++idx)
+        check_round_trip(double(std::int64_t(rng() % 20000000) - 10000000) / 1e6);
+}
+
+TEST(format_decimal_value_round_trip)
+{
+    value source = array({ 0.1, -123.456, 1e-7, 6.02214076e23, std::numeric_limits<double>::max(),
+                           std::numeric_limits<double>::denorm_min()
+                         }
+                        );
+    ensure_eq(source, parse(to_string(source)));
+}
+
+}
@@ -0,0 +1,96 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/parallel.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv::detail;
+
+TEST(parallel_for_visits_every_index_once)
+{
+    for (std::size_t thread_count : { 1, 2, 7, 64 })
+    {
+        std::vector<std::atomic<int>> visits(1000);
+        for (auto& count : visits)
+            count = 0;
+        parallel_for(visits.size(), thread_count, [&] (std::size_t idx) { ++visits[idx]; });
+        for (auto& count : visits)
+            ensure_eq(1, count.load());
+    }
+}
+
+TEST(parallel_for_nothing)
+{
+    parallel_for(0, 4, [] (std::size_t) { throw std::logic_error("should not be called"); });
+}
+
+TEST(parallel_for_rethrows)
+{
+    ensure_throws(std::runtime_error,
+                  parallel_for(1000, 4, [] (std::size_t idx)
+                                        {
+                                            if (idx == 10)
+                                                throw std::runtime_error("boom");
+                                        }
+                              )
+                 );
+}
+
+TEST(thread_pool_runs_many_rounds)
+{
+    thread_pool pool(4);
+    std::vector<std::atomic<int>> visits(100);
+    for (auto& count : visits)
+        count = 0;
+    for (int round = 0; round < 200; ++round)
+        pool.parallel_for(std::size_t(round % 7) * 10, [&] (std::size_t idx) { ++visits[idx]; });
+    
+    for (std::size_t idx = 0; idx < visits.size(); ++idx)
+    {
+        int expected = 0;
+        for (int round = 0; round < 200; ++round)
+            if (idx < std::size_t(round % 7) * 10)
+                ++expected;
+        ensure_eq(expected, visits[idx].load());
+    }
+}
+
+TEST(thread_pool_usable_after_throw)
+{
+    thread_pool pool(3);
+    ensure_throws(std::runtime_error,
+                  pool.parallel_for(100, [] (std::size_t idx)
+                                         {
+                                             if (idx == 5)
+                                                 throw std::runtime_error("boom");
+                                         }
+                                   )
+                 );
+    
+    std::atomic<int> calls(0);
+    pool.parallel_for(100, [&] (std::size_t) { ++calls; });
+    ensure_eq(100, calls.load());
+}
+
+TEST(resolve_thread_count)
+{
+    ensure_eq(3U, resolve_thread_count(3));
+    ensure(resolve_thread_count(0) >= 1U);
+}
+
+}
@@ -0,0 +1,149 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv-tests/test.hpp>
+
+#include <jsonv/detail/simd_scan.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv::detail;
+
+static std::string random_input(std::mt19937& rng, std::size_t length, const std::string& alphabet)
+{
+    std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+    std::string out;
+    for (std::size_t idx = 0; idx < length; ++idx)
+        out += alphabet[pick(rng)];
+    return out;
+}
+
+TEST(simd_scan_find_quote_or_backslash_matches_scalar)
+{
+    const simd_scanner& scalar = get_simd_scanner(simd_level::scalar);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<std::size_t> length_dist(0, 200);
+
+    for (auto level : { simd_level::sse2, simd_level::avx2 })
+    {
+        const simd_scanner& vector = get_simd_scanner(level);
+        for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+        {
+            // mostly plain text with the occasional target character
+            std::string input = random_input(rng, length_dist(rng), "abcdefghijklmnopqrstuvwxyz0123456789 \t\x80\xff")
+                              + random_input(rng, length_dist(rng) % 3, "\"\\")
+                              + random_input(rng, length_dist(rng), "abc\"\\");
+            for (std::size_t offset = 0; offset < std::min<std::size_t>(input.size(), 40); ++offset)
+            {
+                const char* begin = input.data() + offset;
+                const char* end   = input.data() + input.size();
+                ensure(scalar.find_quote_or_backslash(begin, end) == vector.find_quote_or_backslash(begin, end));
+            }
+        }
+    }
+}
+
+TEST(simd_scan_skip_whitespace_matches_scalar)
+{
+    const simd_scanner& scalar = get_simd_scanner(simd_level::scalar);
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<std::size_t> length_dist(0, 200);
+
+    for (auto level : { simd_level::sse2, simd_level::avx2 })
+    {
+        const simd_scanner& vector = get_simd_scanner(level);
+        for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+        {
+            std::string input = random_input(rng, length_dist(rng), " \t\r\n")
+                              + random_input(rng, length_dist(rng) % 4, "{}[]\",:\v\x80");
+            for (std::size_t offset = 0; offset < std::min<std::size_t>(input.size(), 40); ++offset)
+            {
+                const char* begin = input.data() + offset;
+                const char* end   = input.data() + input.size();
+                ensure(scalar.skip_whitespace(begin, end) == vector.skip_whitespace(begin, end));
+            }
+        }
+    }
+}
+
+TEST(simd_scan_find_encode_special_matches_scalar)
+{
+    const simd_scanner& scalar = get_simd_scanner(simd_level::scalar);
+    std::mt19937 rng(9012);
+    std::uniform_int_distribution<std::size_t> length_dist(0, 200);
+
+    for (auto level : { simd_level::sse2, simd_level::avx2 })
+    {
+        const simd_scanner& vector = get_simd_scanner(level);
+        for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+        {
+            std::string input = random_input(rng, length_dist(rng), "abcdefghijklmnopqrstuvwxyz0123456789 ~!{}")
+                              + random_input(rng, length_dist(rng) % 3,
+                                             std::string("\"\\/\x7f\x80\xc3\xff\x1f\n\t") + '\0'
+                                            )
+                              + random_input(rng, length_dist(rng), "abc /\x01");
+            for (std::size_t offset = 0; offset < std::min<std::size_t>(input.size(), 40); ++offset)
+            {
+                const char* begin = input.data() + offset;
+                const char* end   = input.data() + input.size();
+                ensure(scalar.find_encode_special(begin, end) == vector.find_encode_special(begin, end));
+            }
+        }
+    }
+}
+
+TEST(simd_scan_find_decode_special_matches_scalar)
+{
+    const simd_scanner& scalar = get_simd_scanner(simd_level::scalar);
+    std::mt19937 rng(3456);
+    std::uniform_int_distribution<std::size_t> length_dist(0, 200);
+
+    for (auto level : { simd_level::sse2, simd_level::avx2 })
+    {
+        const simd_scanner& vector = get_simd_scanner(level);
+        for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+        {
+            std::string input = random_input(rng, length_dist(rng), "abcdefghijklmnopqrstuvwxyz0123456789 ~!{}")
+                              + random_input(rng, length_dist(rng) % 3,
+                                             std::string("\"\\/\x7f\x80\xc3\xff\x1f\n\t") + '\0'
+                                            )
+                              + random_input(rng, length_dist(rng), "abc \\\x01\xe2");
+            for (std::size_t offset = 0; offset < std::min<std::size_t>(input.size(), 40); ++offset)
+            {
+                const char* begin = input.data() + offset;
+                const char* end   = input.data() + input.size();
+                ensure(scalar.find_decode_special(begin, end) == vector.find_decode_special(begin, end));
+            }
+        }
+    }
+}
+
+TEST(simd_scan_empty_ranges)
+{
+    const char* text = "\"";
+    for (auto level : { simd_level::scalar, simd_level::sse2, simd_level::avx2 })
+    {
+        const simd_scanner& scanner = get_simd_scanner(level);
+        ensure(scanner.find_quote_or_backslash(text, text) == text);
+        ensure(scanner.skip_whitespace(text, text) == text);
+        ensure(scanner.find_encode_special(text, text) == text);
+        ensure(scanner.find_decode_special(text, text) == text);
+        ensure(scanner.find_quote_or_backslash(text, text + 1) == text);
+        ensure(scanner.skip_whitespace(text, text + 1) == text);
+        ensure(scanner.find_encode_special(text, text + 1) == text);
+    }
+}
+
+}
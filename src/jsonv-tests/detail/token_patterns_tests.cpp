@@ -112,6 +112,41 @@ TEST(token_attempt_match_string_double_reverse_solidus_before_escaped_quote)
     ensure_eq(sstrlen(tokens), length);
 }
 
+TEST(token_attempt_match_string_long_with_escapes)
+{
+    static const char tokens[] = R"("this string is long enough to span multiple \"vector\" blocks \\ and then \"some\"" more)";
+    
+    token_kind kind;
+    std::size_t length;
+    match_result result = static_attempt_match(tokens, kind, length);
+    ensure(result == match_result::complete);
+    ensure_eq(token_kind::string, kind);
+    ensure_eq(sstrlen(tokens) - 5, length);
+}
+
+TEST(token_attempt_match_string_long_unterminated)
+{
+    static const char tokens[] = R"("this string is long enough to span multiple vector blocks but never ends \")";
+    
+    token_kind kind;
+    std::size_t length;
+    match_result result = static_attempt_match(tokens, kind, length);
+    ensure(result == match_result::unmatched);
+    ensure_eq(token_kind::string, kind);
+}
+
+TEST(token_attempt_match_whitespace_long)
+{
+    static const char tokens[] = " \t\r\n                                      \t\t\t\t\t\t\n\n\n\r\r\r   {";
+    
+    token_kind kind;
+    std::size_t length;
+    match_result result = static_attempt_match(tokens, kind, length);
+    ensure(result == match_result::complete);
+    ensure_eq(token_kind::whitespace, kind);
+    ensure_eq(sstrlen(tokens) - 1, length);
+}
+
 TEST(token_attempt_match_comment)
 {
     static const char tokens[] = "/**/";
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <locale>
 #include <sstream>
+#include <stdexcept>
 
 namespace jsonv_test
 {
@@ -39,6 +40,133 @@ TEST(encode_pretty_print)
     encoder.encode(val);
 }
 
+TEST(encode_pretty_print_layout)
+{
+    static const char expected[] = R"({
+  "a": [
+    4,
+    5,
+    6,
+    [
+      7,
+      8,
+      9,
+      {
+        "else": 6,
+        "something": 5
+      }
+    ]
+  ],
+  "b": "blah",
+  "c": {
+    "baz": [
+      "bazar"
+    ],
+    "cat": [
+      "Eric",
+      "Bob"
+    ]
+  },
+  "d": {},
+  "e": [],
+  "f": null,
+  "g": [
+    true,
+    false
+  ]
+})";
+    
+    std::ostringstream ss;
+    jsonv::ostream_pretty_encoder encoder(ss);
+    encoder.encode(jsonv::parse(k_some_json));
+    ensure_eq(expected, ss.str());
+    
+    std::string buffered;
+    jsonv::buffer_pretty_encoder(buffered).encode(jsonv::parse(k_some_json));
+    ensure_eq(expected, buffered);
+}
+
+TEST(encode_pretty_print_compact)
+{
+    static const char expected[] = R"({
+  "a": [
+    4,
+    5,
+    6,
+    [
+      7,
+      8,
+      9,
+      {"else": 6, "something": 5}
+    ]
+  ],
+  "b": "blah",
+  "c": {
+    "baz": ["bazar"],
+    "cat": ["Eric", "Bob"]
+  },
+  "d": {},
+  "e": [],
+  "f": null,
+  "g": [true, false]
+})";
+    
+    std::ostringstream ss;
+    jsonv::ostream_pretty_encoder encoder(ss);
+    encoder.compact_width(40);
+    encoder.encode(jsonv::parse(k_some_json));
+    ensure_eq(expected, ss.str());
+    ensure_eq(jsonv::parse(k_some_json), jsonv::parse(ss.str()));
+}
+
+TEST(encode_pretty_print_compact_width)
+{
+    auto encode = [] (const jsonv::value& val, std::size_t width)
+                  {
+                      std::string out;
+                      jsonv::buffer_pretty_encoder encoder(out);
+                      encoder.compact_width(width);
+                      encoder.encode(val);
+                      return out;
+                  };
+    
+    jsonv::value val = jsonv::array({ 1, "two", 3.5 });
+    ensure_eq(std::string(R"([1, "two", 3.5])"), encode(val, 15));
+    ensure_eq(std::string("[\n  1,\n  \"two\",\n  3.5\n]"), encode(val, 14));
+    ensure_eq(std::string("[\n  1,\n  \"two\",\n  3.5\n]"), encode(val, 0));
+    
+    // running out of room in the middle of an entry or right after a delimiter
+    for (std::size_t width = 1; width < 40; ++width)
+    {
+        jsonv::value obj = jsonv::object({ { "key", jsonv::array({ 1, 2, 3 }) }, { "other", "abcdefghijkl" } });
+        ensure_eq(obj, jsonv::parse(encode(obj, width)));
+        ensure(encode(obj, 0).size() >= encode(obj, width).size());
+    }
+}
+
+TEST(encode_pretty_print_compact_sink)
+{
+    // a container being kept on one line must not be split across chunks
+    jsonv::value val = jsonv::array();
+    for (int idx = 0; idx < 200; ++idx)
+        val.push_back(jsonv::array({ idx, idx * 2, "some text" }));
+    
+    std::string chunked;
+    {
+        auto sink = [&chunked] (jsonv::string_view chunk) { chunked.append(chunk.data(), chunk.size()); };
+        jsonv::buffer_pretty_encoder encoder(sink, 2, 16);
+        encoder.compact_width(30);
+        encoder.encode(val);
+    }
+    
+    std::string direct;
+    jsonv::buffer_pretty_encoder encoder(direct);
+    encoder.compact_width(30);
+    encoder.encode(val);
+    ensure_eq(direct, chunked);
+    ensure_eq(val, jsonv::parse(direct));
+}
+
 TEST(encode_nan)
 {
     auto val = jsonv::parse(k_some_json);
@@ -104,4 +232,186 @@ TEST(encode_invalid_utf8_uses_replacement_at_end)
     ensure_eq(output, "\"\\u00e8\"");
 }
 
+static std::string encode_with_ostream(const jsonv::value& val, bool ensure_ascii = true)
+{
+    std::ostringstream ss;
+    jsonv::ostream_encoder encoder(ss);
+    encoder.ensure_ascii(ensure_ascii);
+    encoder.encode(val);
+    return ss.str();
+}
+
+static const jsonv::value k_mixed_value = jsonv::object({
+    { "integers",  jsonv::array({ 0, 7, -7, 10, 99, 100, -100, 12345678901234, INT64_MAX, INT64_MIN }) },
+    { "decimals",  jsonv::array({ 0.5, -1.25, 3.141592653589793, 1e100, -2.5e-10, 100000.0, 1000000.0 }) },
+    { "strings",   jsonv::array({ "", "plain", "quote\" slash/ back\\", "\t\r\n\b\f\x01\x7f", "caf\xc3\xa9",
+                                  "\xf0\x9f\x98\x80", "N\xc1pX" }) },
+    { "literals",  jsonv::array({ true, false, jsonv::null }) },
+    { "nested",    jsonv::object({ { "a", jsonv::array() }, { "b", jsonv::object() } }) },
+});
+
+TEST(buffer_encoder_matches_ostream_encoder)
+{
+    for (bool ensure_ascii : { true, false })
+    {
+        std::string out;
+        jsonv::buffer_encoder encoder(out);
+        encoder.ensure_ascii(ensure_ascii);
+        encoder.encode(k_mixed_value);
+        ensure_eq(encode_with_ostream(k_mixed_value, ensure_ascii), out);
+    }
+    ensure_eq(encode_with_ostream(k_mixed_value), jsonv::to_string(k_mixed_value));
+}
+
+TEST(buffer_encoder_appends)
+{
+    std::string out = "x=";
+    jsonv::buffer_encoder encoder(out);
+    encoder.encode(jsonv::array({ 1, 2 }));
+    ensure_eq("x=[1,2]", out);
+}
+
+TEST(buffer_encoder_sink_chunks)
+{
+    std::string expected = encode_with_ostream(k_mixed_value);
+    std::string received;
+    std::size_t chunks = 0;
+    {
+        jsonv::buffer_encoder encoder([&] (jsonv::string_view chunk)
+                                      {
+                                          ++chunks;
+                                          received.append(chunk.data(), chunk.size());
+                                      },
+                                      16
+                                     );
+        encoder.encode(k_mixed_value);
+        ensure(received.size() < expected.size());
+    }
+    ensure_eq(expected, received);
+    ensure(chunks > 1U);
+}
+
+
+static jsonv::value make_export_document(std::size_t records)
+{
+    jsonv::value data = jsonv::array();
+    for (std::size_t idx = 0; idx < records; ++idx)
+    {
+        data.push_back(jsonv::object({ { "id",    int(idx) },
+                                       { "name",  "record caf\xc3\xa9 " + std::to_string(idx) },
+                                       { "score", double(idx) / 7.0 },
+                                       { "tags",  jsonv::array({ "a", "b", idx % 2 == 0 }) },
+                                     }
+                                    )
+                      );
+    }
+    jsonv::value members = jsonv::object();
+    for (std::size_t idx = 0; idx < records / 2; ++idx)
+        members["key" + std::to_string(idx)] = k_mixed_value;
+    return jsonv::object({ { "meta", k_mixed_value }, { "data", data }, { "members", members } });
+}
+
+TEST(buffer_encoder_parallel_matches_sequential)
+{
+    jsonv::value doc = make_export_document(3000);
+    for (bool ensure_ascii : { true, false })
+    {
+        std::string expected;
+        jsonv::buffer_encoder sequential(expected);
+        sequential.ensure_ascii(ensure_ascii);
+        sequential.encode(doc);
+
+        for (std::size_t thread_count : { 1, 2, 3, 8 })
+        {
+            for (std::size_t min_entries : { 1, 2, 256, 100000 })
+            {
+                std::string out;
+                jsonv::buffer_encoder encoder(out);
+                encoder.ensure_ascii(ensure_ascii);
+                encoder.encode_parallel(doc, thread_count, min_entries);
+                ensure_eq(expected, out);
+            }
+        }
+    }
+}
+
+TEST(buffer_encoder_parallel_sink)
+{
+    jsonv::value doc = make_export_document(2000);
+    std::string received;
+    {
+        jsonv::buffer_encoder encoder([&] (jsonv::string_view chunk) { received.append(chunk.data(), chunk.size()); },
+                                      1024
+                                     );
+        encoder.encode_parallel(doc, 4, 16);
+    }
+    ensure_eq(jsonv::to_string(doc), received);
+}
+
+TEST(buffer_encoder_parallel_scalars_and_pretty)
+{
+    std::string out;
+    jsonv::buffer_encoder encoder(out);
+    encoder.encode_parallel(5, 4);
+    encoder.encode_parallel(jsonv::array(), 4, 1);
+    encoder.encode_parallel(jsonv::object(), 4, 1);
+    ensure_eq("5[]{}", out);
+
+    // pretty printing needs to know the indentation, so it always happens on the calling thread
+    jsonv::value doc = make_export_document(50);
+    std::string expected;
+    jsonv::buffer_pretty_encoder(expected).encode(doc);
+    std::string pretty;
+    jsonv::buffer_pretty_encoder(pretty).encode_parallel(doc, 4, 1);
+    ensure_eq(expected, pretty);
+}
+
+TEST(event_writer_delimiters)
+{
+    std::ostringstream os;
+    jsonv::ostream_encoder encoder(os);
+    jsonv::event_writer out(encoder);
+    out.object_begin();
+    out.key("a");
+    out.array_begin();
+    out.integer(1);
+    out.value(jsonv::object({ { "x", jsonv::null } }));
+    out.array_begin();
+    out.array_end();
+    out.string("s");
+    out.array_end();
+    out.key("b");
+    out.object_begin();
+    out.object_end();
+    out.key("c");
+    out.boolean(false);
+    out.object_end();
+    ensure_eq(R"({"a":[1,{"x":null},[],"s"],"b":{},"c":false})", os.str());
+    ensure_throws(std::logic_error, out.null());
+}
+
+TEST(event_writer_misuse)
+{
+    std::ostringstream os;
+    jsonv::ostream_encoder encoder(os);
+    {
+        jsonv::event_writer out(encoder);
+        out.array_begin();
+        ensure_throws(std::logic_error, out.key("a"));
+        ensure_throws(std::logic_error, out.object_end());
+    }
+    {
+        jsonv::event_writer out(encoder);
+        out.object_begin();
+        ensure_throws(std::logic_error, out.integer(1));
+        out.key("a");
+        ensure_throws(std::logic_error, out.key("b"));
+        ensure_throws(std::logic_error, out.object_end());
+    }
+    {
+        jsonv::event_writer out(encoder);
+        ensure_throws(std::logic_error, out.array_end());
+    }
+}
+
 }
@@ -11,10 +11,13 @@
 **/
 #include "test.hpp"
 
+#include <jsonv/encode.hpp>
 #include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
 
 #include <fstream>
 #include <memory>
+#include <sstream>
 
 #include <jsonv-tests/filesystem_util.hpp>
 
@@ -28,19 +31,38 @@ public:
     explicit json_checker_test(const std::string&          datapath,
                                const std::string&          test_name_post,
                                bool                        expect_failure,
-                               const jsonv::parse_options& options
+                               const jsonv::parse_options& options,
+                               bool                        events = false
                               ) :
             unit_test(std::string("json_checker_test/") + filename(datapath) + test_name_post),
             _datapath(datapath),
             _expect_failure(expect_failure),
-            _options(options)
+            _options(options),
+            _events(events)
     { }
     
 private:
     virtual void run_impl() override
     {
         std::ifstream file(_datapath.c_str());
-        if (_expect_failure)
+        if (_events)
+        {
+            std::ostringstream minified;
+            jsonv::ostream_encoder encoder(minified);
+            if (_expect_failure)
+            {
+                ensure_throws(jsonv::parse_error, jsonv::parse_events(file, encoder, _options));
+            }
+            else
+            {
+                jsonv::parse_events(file, encoder, _options);
+                std::ifstream again(_datapath.c_str());
+                // compare after a round trip through text, since decimals are not encoded exactly
+                jsonv::value expected = jsonv::parse(jsonv::to_string(jsonv::parse(again, _options)));
+                ensure_eq(expected, jsonv::parse(minified.str()));
+            }
+        }
+        else if (_expect_failure)
         {
             ensure_throws(jsonv::parse_error, jsonv::parse(file, _options));
         }
@@ -54,6 +76,7 @@ private:
     std::string          _datapath;
     bool                 _expect_failure;
     jsonv::parse_options _options;
+    bool                 _events;
 };
 
 class json_checker_test_initializer
@@ -72,6 +95,15 @@ public:
                                                    );
             _tests.emplace_back(std::move(test));
             
+            std::unique_ptr<json_checker_test> events(new json_checker_test(p,
+                                                                            "+events",
+                                                                            expect_failure,
+                                                                            jsonv::parse_options::create_default(),
+                                                                            true
+                                                                           )
+                                                     );
+            _tests.emplace_back(std::move(events));
+            
             if (filename(p).find("pass-but-fail-strict") == 0)
             {
                 std::unique_ptr<json_checker_test> strict(new json_checker_test(p,
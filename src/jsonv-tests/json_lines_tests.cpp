@@ -0,0 +1,205 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+
+#include <jsonv/encode.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+static const char sample_lines[] = "{\"id\": 1, \"tags\": [\"a\", \"b\"]}\n"
+                                   "\n"
+                                   "  [1, 2.5, null]\r\n"
+                                   "\"line\\nfeed\"\n"
+                                   " \t \n"
+                                   "true";
+
+static std::vector<value> sample_values()
+{
+    return { object({ { "id", 1 }, { "tags", array({ "a", "b" }) } }), array({ 1, 2.5, null }), "line\nfeed", true };
+}
+
+static std::vector<value> read_all(json_lines_reader& reader)
+{
+    std::vector<value> out;
+    value x;
+    while (reader.next(x))
+        out.push_back(x);
+    return out;
+}
+
+TEST(json_lines_reader_string)
+{
+    json_lines_reader reader(sample_lines);
+    ensure_eq(0U, reader.line());
+    value x;
+    ensure(reader.next(x));
+    ensure_eq(1U, reader.line());
+    ensure(reader.next(x));
+    ensure_eq(3U, reader.line());
+    ensure_eq(2U, read_all(reader).size());
+    ensure_eq(6U, reader.line());
+
+    json_lines_reader again(sample_lines);
+    ensure(sample_values() == read_all(again));
+    ensure(!again.next(x));
+}
+
+TEST(json_lines_reader_stream)
+{
+    std::istringstream stream(sample_lines);
+    json_lines_reader reader(stream);
+    ensure(sample_values() == read_all(reader));
+    ensure_eq(6U, reader.line());
+}
+
+TEST(json_lines_reader_problem_locations)
+{
+    std::string src = "[1]\n[2]\n{\"a\": 1 \"b\": 2}\n[4]\n";
+    json_lines_reader reader(src);
+    value x;
+    ensure(reader.next(x));
+    ensure(reader.next(x));
+    try
+    {
+        reader.next(x);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        const parse_error::problem& problem = err.problems().front();
+        ensure_eq(3U, problem.line());
+        ensure_eq(src.find("\"b\""), problem.character());
+        ensure_eq(src.find("\"b\"") - src.find('{') + 1, problem.column());
+    }
+    ensure(reader.next(x));
+    ensure_eq(array({ 4 }), x);
+    ensure(!reader.next(x));
+}
+
+TEST(json_lines_reader_batch)
+{
+    std::ostringstream src;
+    for (int idx = 0; idx < 1000; ++idx)
+        src << "{\"id\": " << idx << ", \"name\": \"entry " << idx << "\"}\n" << (idx % 7 == 0 ? "\n" : "");
+
+    for (bool from_stream : { false, true })
+    {
+        std::string        text = src.str();
+        std::istringstream stream(text);
+        std::unique_ptr<json_lines_reader> reader(from_stream ? new json_lines_reader(stream)
+                                                              : new json_lines_reader(text)
+                                                 );
+        std::vector<value> out;
+        std::size_t count;
+        while ((count = reader->next_batch(out, 64, 4)) > 0)
+            ensure(count <= 64U);
+        ensure_eq(1000U, out.size());
+        for (int idx = 0; idx < 1000; ++idx)
+            ensure_eq(idx, out[idx].at("id").as_integer());
+    }
+}
+
+TEST(json_lines_reader_batch_everything)
+{
+    std::istringstream stream("[1]\n\n[2]\n");
+    json_lines_reader reader(stream);
+    std::vector<value> out;
+    ensure_eq(2U, reader.next_batch(out, std::numeric_limits<std::size_t>::max()));
+    ensure_eq(array({ 1 }), out[0]);
+    ensure_eq(array({ 2 }), out[1]);
+    ensure_eq(0U, reader.next_batch(out, std::numeric_limits<std::size_t>::max()));
+}
+
+TEST(json_lines_reader_batch_problems)
+{
+    std::string src = "[0]\n[1,\n[2]\n{3}\n[4]\n";
+    json_lines_reader reader(src, parse_options().failure_mode(parse_options::on_error::collect_all));
+    std::vector<value> out;
+    try
+    {
+        reader.next_batch(out, 10, 3);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(5U, out.size());
+        ensure_eq(array({ 4 }), out[4]);
+        ensure(err.problems().size() >= 2U);
+        ensure_eq(2U, err.problems().front().line());
+        ensure_eq(4U, err.problems().back().line());
+    }
+    ensure_eq(0U, reader.next_batch(out, 10));
+}
+
+TEST(json_lines_reader_interning_is_bounded)
+{
+    std::ostringstream src;
+    src << "{\"id\": \"same\"}\n{\"id\": \"same\"}\n";
+    for (int idx = 0; idx < 100000; ++idx)
+        src << "{\"id\": \"user-" << idx << "\"}\n";
+    src << "{\"id\": \"same\"}\n";
+    
+    std::string       text = src.str();
+    json_lines_reader reader(text, parse_options().intern_strings(true));
+    value first, second, current;
+    ensure(reader.next(first));
+    ensure(reader.next(second));
+    // strings are shared from one line to the next...
+    ensure(&first.at("id").as_string() == &second.at("id").as_string());
+    
+    for (int idx = 0; idx < 100000; ++idx)
+    {
+        ensure(reader.next(current));
+        ensure_eq(value("user-" + std::to_string(idx)), current.at("id"));
+    }
+    
+    // ...but not all of them are kept forever
+    ensure(reader.next(current));
+    ensure_eq(first, current);
+    ensure(&first.at("id").as_string() != &current.at("id").as_string());
+    ensure(!reader.next(current));
+}
+
+TEST(json_lines_encoder_round_trip)
+{
+    std::ostringstream stream;
+    json_lines_encoder encoder(stream);
+    for (const value& x : sample_values())
+        encoder.encode(x);
+    encoder.encode(object({ { "unicode", "\xe2\x98\x83" } }));
+
+    std::string text = stream.str();
+    ensure_eq("{\"id\":1,\"tags\":[\"a\",\"b\"]}\n"
+              "[1,2.5,null]\n"
+              "\"line\\nfeed\"\n"
+              "true\n"
+              "{\"unicode\":\"\\u2603\"}\n",
+              text
+             );
+
+    json_lines_reader reader(text);
+    std::vector<value> expected = sample_values();
+    expected.push_back(object({ { "unicode", "\xe2\x98\x83" } }));
+    ensure(expected == read_all(reader));
+}
+
+}
@@ -0,0 +1,185 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+#include "filesystem_util.hpp"
+
+#include <jsonv/lazy_document.hpp>
+#include <jsonv/memory_resource.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+#include <jsonv/detail/simple_decode.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace jsonv_test
+{
+
+using namespace jsonv;
+
+static const std::string sample_document = R"({
+        "id": 12,
+        "ratio": 0.25,
+        "big": 1e300,
+        "name": "sample",
+        "tags": ["a", "b", { "nested": [1, [2, [3]]] }, "d"],
+        "owner": { "name": "someone", "roles": ["admin", "user"] },
+        "esc\u0061ped": "key",
+        "empty": {},
+        "nothing": null,
+        "flag": true
+    })";
+
+/** Walk every value in \a expected and check \a actual agrees at each one. **/
+static void check_matches(const value& expected, const lazy_value& actual)
+{
+    if (expected.kind() != actual.kind() || expected != actual.to_value())
+        throw std::runtime_error("Lazy value " + std::string(actual.text()) + " does not match " + to_string(expected));
+
+    if (expected.kind() == kind::array || expected.kind() == kind::object)
+    {
+        if (expected.size() != actual.size())
+            throw std::runtime_error("Lazy value " + std::string(actual.text()) + " has the wrong size");
+
+        if (expected.kind() == kind::array)
+            for (value::size_type idx = 0; idx < expected.size(); ++idx)
+                check_matches(expected.at(idx), actual.at(idx));
+        else
+            for (const auto& entry : expected.as_object())
+                check_matches(entry.second, actual.at(entry.first));
+    }
+}
+
+TEST(lazy_document_matches_parse)
+{
+    lazy_document doc(sample_document);
+    check_matches(parse(sample_document), doc.root());
+
+    for (const char* name : { "canada.json", "paths.json", "generated.json" })
+    {
+        std::ifstream file(test_path(name).c_str());
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        std::string text = contents.str();
+        ensure_eq(parse(text), lazy_document(text).root().to_value());
+    }
+}
+
+TEST(lazy_document_navigation)
+{
+    lazy_document doc(sample_document);
+    lazy_value root = doc.root();
+    ensure_eq(kind::integer, root.at("id").kind());
+    ensure_eq(kind::decimal, root.at("ratio").kind());
+    ensure_eq(kind::decimal, root.at("big").kind());
+    ensure_eq(string_view("\"sample\""), root.at("name").text());
+    ensure_eq(string_view("[1, [2, [3]]]"), root.at("tags").at(2).at("nested").text());
+    ensure_eq(value("d"), root.at("tags").at(3).to_value());
+    ensure_eq(value("key"), root.at("escaped").to_value());
+    ensure_eq(10U, root.entries().size());
+    ensure_eq(std::string("escaped"), root.entries().at(6).first);
+    ensure_eq(value("key"), root.entries().at(6).second.to_value());
+    ensure_eq(3, root.at_path(".tags[2].nested[1][1][0]").to_value().as_integer());
+    ensure_eq(value("user"), root.at_path(path({ "owner", "roles", 1 })).to_value());
+    ensure_eq(0U, root.at("empty").size());
+    ensure(!root.find("missing"));
+    ensure(!!root.find("nothing"));
+
+    ensure_throws(std::out_of_range, root.at("missing"));
+    ensure_throws(std::out_of_range, root.at("tags").at(4));
+    ensure_throws(std::out_of_range, root.at_path(".owner.roles[2]"));
+    ensure_throws(kind_error, root.at(0));
+    ensure_throws(kind_error, root.at("tags").at("a"));
+    ensure_throws(kind_error, root.at("name").size());
+    ensure_throws(kind_error, root.at_path(".name[0]"));
+}
+
+TEST(lazy_document_problem_locations)
+{
+    for (const char* src : { "", "[1, 2", "{\"a\": 1 \"b\": 2}", "[1,\n 2 }", "{\"a\" 1}", "{1: 2}", "[1]\n  [2]",
+                             "[1, ]]", "  ", "[1, 2\n  "
+                           }
+        )
+    {
+        std::string expected;
+        try
+        {
+            parse(src);
+        }
+        catch (const parse_error& err)
+        {
+            expected = to_string(err.problems().front());
+        }
+
+        std::string actual;
+        try
+        {
+            lazy_document doc(src);
+        }
+        catch (const parse_error& err)
+        {
+            actual = to_string(err.problems().front());
+        }
+        ensure_eq(expected, actual);
+    }
+
+    ensure_throws(parse_error, lazy_document("[tru]"));
+    ensure_throws(parse_error, lazy_document("[\"unterminated]"));
+}
+
+TEST(lazy_document_options)
+{
+    ensure_throws(parse_error, lazy_document("[1, /* one */ 2]", parse_options().comments(false)));
+    ensure_throws(parse_error, lazy_document("[1, 2,]", parse_options().comma_policy(parse_options::commas::strict)));
+    ensure_throws(parse_error, lazy_document("[[[1]]]", parse_options().max_structure_depth(3)));
+    ensure_throws(parse_error, lazy_document("12", parse_options().require_document(true)));
+    ensure_eq(2U, lazy_document("[1, 2] 3", parse_options().complete_parse(false)).root().size());
+}
+
+TEST(lazy_value_decode_simple)
+{
+    value out;
+    ensure(detail::decode_simple(R"("plain text")", kind::string, parse_options(), out));
+    ensure_eq(value("plain text"), out);
+    ensure(detail::decode_simple("-12", kind::integer, parse_options(), out));
+    ensure_eq(value(-12), out);
+    ensure(detail::decode_simple("false", kind::boolean, parse_options(), out));
+    ensure_eq(value(false), out);
+    
+    // anything which might not come out the same goes through parse
+    ensure(!detail::decode_simple(R"("esc\u0061ped")", kind::string, parse_options(), out));
+    ensure(!detail::decode_simple(R"("plain text")", kind::string, parse_options().borrow_input(true), out));
+    ensure(!detail::decode_simple("012", kind::integer, parse_options::create_strict(), out));
+    
+    monotonic_buffer_resource arena;
+    ensure(!detail::decode_simple(R"("plain text")", kind::string, parse_options().resource(&arena), out));
+}
+
+TEST(lazy_document_decode_problems_located)
+{
+    std::string src = "{\n  \"ok\": \"fine\",\n  \"bad\": \"\xc3\"\n}";
+    lazy_document doc(src, parse_options().string_encoding(parse_options::encoding::utf8_strict));
+    ensure_eq(value("fine"), doc.root().at("ok").to_value());
+    try
+    {
+        doc.root().at("bad").to_value();
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(3U, err.problems().front().line());
+        ensure_eq(src.find("\"\xc3"), err.problems().front().character());
+    }
+}
+
+}
@@ -0,0 +1,136 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include "test.hpp"
+
+#include <jsonv/memory_resource.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/value.hpp>
+
+namespace jsonv_test
+{
+
+namespace
+{
+
+static const char sample_document[] = R"({
+        "name": "a name which is far too long to fit in the small-string buffer",
+        "id": 1,
+        "tags": ["a", "b", "c"],
+        "nested": { "x": [1.5, null, true], "y": {} }
+    })";
+
+/** Forwards to \c new_delete_resource, keeping track of what is outstanding. **/
+class counting_resource :
+        public jsonv::memory_resource
+{
+public:
+    std::size_t allocations = 0;
+    std::size_t outstanding = 0;
+
+protected:
+    virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        ++outstanding;
+        return jsonv::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        --outstanding;
+        jsonv::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    virtual bool do_is_equal(const jsonv::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+}
+
+TEST(memory_resource_parse_matches_heap_parse)
+{
+    jsonv::monotonic_buffer_resource arena(256);
+    jsonv::value from_arena = jsonv::parse(sample_document, jsonv::parse_options().resource(&arena));
+    ensure(arena.upstream_bytes() > 0U);
+    ensure_eq(jsonv::parse(sample_document), from_arena);
+}
+
+TEST(memory_resource_everything_given_back)
+{
+    counting_resource resource;
+    {
+        jsonv::value x = jsonv::parse(sample_document, jsonv::parse_options().resource(&resource));
+        ensure(resource.allocations > 0U);
+        x["nested"]["x"].push_back(jsonv::parse("[{}]"));
+        x.erase("tags");
+    }
+    ensure_eq(0U, resource.outstanding);
+}
+
+TEST(memory_resource_copy_is_heap_backed)
+{
+    jsonv::value copy;
+    {
+        counting_resource resource;
+        jsonv::value x = jsonv::parse(sample_document, jsonv::parse_options().resource(&resource));
+        std::size_t allocations = resource.allocations;
+        copy = x;
+        ensure_eq(allocations, resource.allocations);
+
+        jsonv::value id_copy = x.at("name");
+        ensure_eq(allocations, resource.allocations);
+        ensure_eq(x.at("name"), id_copy);
+    }
+    ensure_eq(jsonv::parse(sample_document), copy);
+}
+
+TEST(memory_resource_mix_with_heap)
+{
+    jsonv::value heap = jsonv::object();
+    jsonv::monotonic_buffer_resource arena;
+    {
+        jsonv::value x = jsonv::parse(sample_document, jsonv::parse_options().resource(&arena));
+        x["tags"].push_back(jsonv::array({ "from", "the", "heap" }));
+        heap["moved"] = std::move(x["nested"]);
+        heap["copied"] = x["tags"];
+    }
+    ensure_eq(jsonv::parse(R"({ "x": [1.5, null, true], "y": {} })"), heap.at("moved"));
+    ensure_eq(jsonv::parse(R"(["a", "b", "c", ["from", "the", "heap"]])"), heap.at("copied"));
+
+    // heap.at("moved") still lives in the arena; dropping it before the arena is destroyed is required
+    heap.erase("moved");
+}
+
+TEST(memory_resource_incremental_parser)
+{
+    jsonv::monotonic_buffer_resource arena;
+    jsonv::incremental_parser parser(jsonv::parse_options().resource(&arena));
+    parser.feed(R"({ "a": ["b",)");
+    ensure(jsonv::incremental_parser::status::complete == parser.feed(R"( "c"] })"));
+    ensure(arena.upstream_bytes() > 0U);
+    ensure_eq(jsonv::parse(R"({ "a": ["b", "c"] })"), parser.result());
+}
+
+TEST(monotonic_buffer_resource_release)
+{
+    jsonv::monotonic_buffer_resource arena(64);
+    void* small = arena.allocate(8, 8);
+    void* large = arena.allocate(1000, 16);
+    ensure(small != large);
+    ensure_eq(0U, reinterpret_cast<std::uintptr_t>(large) % 16);
+    ensure(arena.upstream_bytes() >= 1000U);
+    arena.release();
+    ensure_eq(0U, arena.upstream_bytes());
+}
+
+}
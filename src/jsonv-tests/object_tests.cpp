@@ -14,6 +14,8 @@
 #include <jsonv/object.hpp>
 #include <jsonv/parse.hpp>
 
+#include <map>
+#include <random>
 #include <string>
 #include <utility>
 
@@ -247,3 +249,94 @@ TEST(parse_object_duplicate_keys)
               jsonv::parse(source, jsonv::parse_options().failure_mode(jsonv::parse_options::on_error::ignore))
              );
 }
+
+TEST(parse_object_duplicate_keys_reported_in_order)
+{
+    std::string source = R"({ "b": 1, "a": 2, "b": 3, "a": 4, "a": 5, "c": [1 2] })";
+    try
+    {
+        jsonv::parse(source, jsonv::parse_options().failure_mode(jsonv::parse_options::on_error::collect_all));
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& ex)
+    {
+        ensure_eq(4U, ex.problems().size());
+        ensure(ex.problems()[0].message().find("'b'") != std::string::npos);
+        ensure(ex.problems()[1].message().find("old value 2 with new value 4") != std::string::npos);
+        ensure(ex.problems()[2].message().find("old value 4 with new value 5") != std::string::npos);
+        for (std::size_t idx = 1; idx < ex.problems().size(); ++idx)
+            ensure(ex.problems()[idx - 1].character() < ex.problems()[idx].character());
+        
+        ensure_eq(jsonv::value(5), ex.partial_result().at("a"));
+        ensure_eq(jsonv::value(3), ex.partial_result().at("b"));
+    }
+}
+
+TEST(parse_object_duplicate_key_fails_immediately)
+{
+    try
+    {
+        jsonv::parse(R"({"a":1,"a":2,"b":x})");
+        ensure(false);
+    }
+    catch (const jsonv::parse_error& ex)
+    {
+        ensure_eq(1U, ex.problems().size());
+        ensure(ex.problems()[0].message().find("Duplicate entries for key 'a'") != std::string::npos);
+        ensure_eq(11U, ex.problems()[0].character());
+    }
+}
+
+TEST(object_matches_std_map)
+{
+    std::mt19937 rng(2018);
+    std::uniform_int_distribution<int> key_dist(0, 60);
+    std::uniform_int_distribution<int> op_dist(0, 3);
+    
+    jsonv::value obj = jsonv::object();
+    std::map<std::string, int> expected;
+    for (int step = 0; step < 2000; ++step)
+    {
+        std::string key = "k" + std::to_string(key_dist(rng));
+        switch (op_dist(rng))
+        {
+        case 0:
+            obj[key] = step;
+            expected[key] = step;
+            break;
+        case 1:
+            ensure_eq(expected.insert({ key, step }).second, obj.insert({ key, step }).second);
+            break;
+        case 2:
+            ensure_eq(expected.erase(key), obj.erase(key));
+            break;
+        default:
+        {
+            auto iter = obj.find(key);
+            ensure_eq(expected.count(key), obj.count(key));
+            if (iter != obj.end_object())
+            {
+                ensure_eq(expected.at(key), iter->second.as_integer());
+                obj.erase(iter);
+                expected.erase(key);
+            }
+            break;
+        }
+        }
+        
+        ensure_eq(expected.size(), obj.size());
+    }
+    
+    auto expected_iter = expected.begin();
+    for (const auto& entry : obj.as_object())
+    {
+        ensure_eq(expected_iter->first, entry.first);
+        ensure_eq(expected_iter->second, entry.second.as_integer());
+        ++expected_iter;
+    }
+    ensure(expected_iter == expected.end());
+    
+    jsonv::value copy = obj;
+    ensure_eq(obj, copy);
+    ensure_throws(std::out_of_range, obj.at("not a key"));
+}
@@ -9,13 +9,21 @@
  *  \author Travis Gockel (travis@gockelhut.com)
 **/
 #include "test.hpp"
+#include "filesystem_util.hpp"
 
 #include <jsonv/array.hpp>
+#include <jsonv/encode.hpp>
 #include <jsonv/parse.hpp>
 #include <jsonv/object.hpp>
 #include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/scope_exit.hpp>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <system_error>
 
 using namespace jsonv;
 
@@ -298,3 +306,413 @@ TEST_PARSE(invalid_utf8_input)
 {
     ensure_throws(jsonv::parse_error, jsonv::parse("\"\xe4\""));
 }
+
+static std::string minify_events(const std::string& input, const parse_options& options = parse_options())
+{
+    std::ostringstream out;
+    ostream_encoder encoder(out);
+    parse_events(input, encoder, options);
+    return out.str();
+}
+
+TEST_PARSE(events_minify)
+{
+    std::string src = R"({"a": null, /* note */ "b": [{}, 3, -4.5, false, [[[]]], "\u00e9x\n"],
+                         "c": { "d": true, "e": [] }, "f": 18446744073709551615 })";
+    ensure_eq(to_string(parse(src)), minify_events(src));
+}
+
+TEST_PARSE(events_pretty)
+{
+    std::string src = R"([1, {"x": [2, 3], "y": {}}, "z", []])";
+    std::ostringstream expected;
+    ostream_pretty_encoder(expected).encode(parse(src));
+    
+    std::ostringstream actual;
+    ostream_pretty_encoder encoder(actual);
+    parse_events(src, encoder);
+    ensure_eq(expected.str(), actual.str());
+}
+
+TEST_PARSE(events_scalars)
+{
+    ensure_eq("5", minify_events("  5 "));
+    ensure_eq("\"abc\"", minify_events(R"("abc")"));
+    ensure_eq("null", minify_events("null"));
+}
+
+TEST_PARSE(events_malformed)
+{
+    ensure_throws(parse_error, minify_events(""));
+    ensure_throws(parse_error, minify_events("[1, 2"));
+    ensure_throws(parse_error, minify_events(R"({"a" 1})"));
+    ensure_throws(parse_error, minify_events(R"({"a": 1 "b": 2})"));
+    ensure_throws(parse_error, minify_events("{}/1"));
+    ensure_throws(parse_error, minify_events("try"));
+    ensure_throws(parse_error, minify_events("123.456.789"));
+}
+
+TEST_PARSE(events_strict)
+{
+    auto options = parse_options::create_strict();
+    ensure_throws(parse_error, minify_events("[1, 2,]", options));
+    ensure_throws(parse_error, minify_events(R"({"a": 1,})", options));
+    ensure_throws(parse_error, minify_events("012", options));
+    ensure_throws(parse_error, minify_events("5", options));
+    ensure_throws(parse_error, minify_events("[/* no */]", options));
+    ensure_eq("[1,2]", minify_events("[1, 2,]"));
+    ensure_eq(R"({"a":1})", minify_events(R"({"a": 1,})"));
+}
+
+TEST_PARSE(events_depth)
+{
+    std::string src = R"({"a": null, "b": [{}, 3, 4.5, false, [[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]]]})";
+    minify_events(src);
+    ensure_throws(parse_error, minify_events(src, parse_options::create_strict()));
+}
+
+TEST_PARSE(events_recover)
+{
+    auto options = parse_options().failure_mode(parse_options::on_error::ignore);
+    ensure_eq("[1,2]", minify_events("[1, 2, bogus]", options));
+    ensure_eq(R"([1,{"a":null}])", minify_events(R"([1, {"a": )", options));
+    
+    try
+    {
+        minify_events("[1, 2, bogus]", parse_options().failure_mode(parse_options::on_error::collect_all));
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure(!err.problems().empty());
+        ensure_eq(null, err.partial_result());
+    }
+}
+
+TEST_PARSE(events_option_complete_parse_false)
+{
+    auto options = parse_options().complete_parse(false);
+    std::string input = R"({ "x": [4, 3, 5] })";
+    std::istringstream istream(input + input + input);
+    tokenizer tokens(istream);
+    for (std::size_t x = 0; x < 3; ++x)
+    {
+        std::ostringstream out;
+        ostream_encoder encoder(out);
+        parse_events(tokens, encoder, options);
+        ensure_eq(R"({"x":[4,3,5]})", out.str());
+    }
+}
+
+TEST_PARSE(incremental_single_bytes)
+{
+    std::string src = R"({"a": null, "b": [{}, 3, -4.5e3, false, [[[]]], "éx\"y"], /* c */ "c": { "d": true }})";
+    incremental_parser parser;
+    for (std::size_t idx = 0; idx < src.size(); ++idx)
+    {
+        auto status = parser.feed(src.substr(idx, 1));
+        ensure(status == (idx + 1 == src.size() ? incremental_parser::status::complete
+                                                 : incremental_parser::status::need_more
+                         )
+              );
+    }
+    ensure_eq(parse(src), parser.result());
+    ensure(parser.finish() == incremental_parser::status::complete);
+}
+
+TEST_PARSE(incremental_chunks)
+{
+    std::string src = "[";
+    for (int idx = 0; idx < 500; ++idx)
+        src += R"({"id": )" + std::to_string(idx * 7919) + R"(, "name": "item \"number\" )" + std::to_string(idx)
+             + R"(", "price": 12.)" + std::to_string(idx) + R"(, "tags": ["a", "b"], "ok": true}, )";
+    src += "null]";
+    value expected = parse(src);
+    
+    for (std::size_t chunk_size : { 1U, 3U, 7U, 64U, 1000U })
+    {
+        incremental_parser parser;
+        for (std::size_t idx = 0; idx < src.size(); idx += chunk_size)
+            parser.feed(string_view(src).substr(idx, std::min(chunk_size, src.size() - idx)));
+        ensure(parser.finish() == incremental_parser::status::complete);
+        ensure_eq(expected, parser.result());
+    }
+}
+
+TEST_PARSE(incremental_long_tokens)
+{
+    std::string text;
+    for (int idx = 0; idx < 2000; ++idx)
+        text += (idx % 3 == 0) ? "ab\\\\" : (idx % 3 == 1) ? "c\\\"d" : "\\u00e9f";
+    std::string src = R"({"text": ")" + text + R"(", "big": )" + std::string(300, '7') + ".5"
+                    + R"(, "small": 12345678901234, "after": "x"})";
+    value expected = parse(src);
+    
+    for (std::size_t chunk_size : { 1U, 2U, 5U, 1500U })
+    {
+        incremental_parser parser;
+        for (std::size_t idx = 0; idx < src.size(); idx += chunk_size)
+            parser.feed(string_view(src).substr(idx, std::min(chunk_size, src.size() - idx)));
+        ensure(parser.finish() == incremental_parser::status::complete);
+        ensure(expected == parser.result());
+    }
+}
+
+TEST_PARSE(incremental_scalar_needs_finish)
+{
+    incremental_parser parser;
+    ensure(parser.feed("12") == incremental_parser::status::need_more);
+    ensure(parser.feed("3") == incremental_parser::status::need_more);
+    ensure_throws(std::logic_error, parser.result());
+    ensure(parser.finish() == incremental_parser::status::complete);
+    ensure_eq(value(123), parser.result());
+}
+
+TEST_PARSE(incremental_errors)
+{
+    {
+        incremental_parser parser;
+        ensure_throws(parse_error, parser.feed("[1, }"));
+    }
+    {
+        incremental_parser parser;
+        ensure(parser.feed(R"({"a": [1, )") == incremental_parser::status::need_more);
+        ensure_throws(parse_error, parser.finish());
+    }
+    {
+        incremental_parser parser;
+        ensure(parser.feed("[1] ") == incremental_parser::status::complete);
+        ensure_throws(parse_error, parser.feed(" 5 "));
+    }
+    {
+        incremental_parser parser;
+        ensure_throws(parse_error, parser.finish());
+    }
+}
+
+TEST_PARSE(incremental_collect_all)
+{
+    incremental_parser parser(parse_options().failure_mode(parse_options::on_error::collect_all));
+    try
+    {
+        parser.feed(R"({"a": 1, "a": 2, "b": [1 2]})");
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(2U, err.problems().size());
+        ensure_eq(object({ { "a", 2 }, { "b", array({ 1 }) } }), err.partial_result());
+        
+        // the same problems as parse, so nobody has to care which one found them
+        try
+        {
+            parse(R"({"a": 1, "a": 2, "b": [1 2]})", parse_options().failure_mode(parse_options::on_error::collect_all));
+            ensure(false);
+        }
+        catch (const parse_error& expected)
+        {
+            ensure_eq(expected.problems().front().message(), err.problems().front().message());
+        }
+    }
+}
+
+TEST_PARSE(incremental_multiple_documents)
+{
+    incremental_parser parser(parse_options().complete_parse(false));
+    ensure(parser.feed(R"({"x": 1} [2)") == incremental_parser::status::complete);
+    ensure_eq(object({ { "x", 1 } }), parser.result());
+    parser.reset();
+    ensure(parser.feed("") == incremental_parser::status::need_more);
+    ensure(parser.feed(", 3]") == incremental_parser::status::complete);
+    ensure_eq(array({ 2, 3 }), parser.result());
+}
+
+TEST_PARSE(intern_strings)
+{
+    std::string src = R"([{"kind": "Feature", "name": "aé"}, {"kind": "Feature", "name": "aé"},
+                          {"kind": "Other", "name": ")" + std::string(100, 'z') + R"("}])";
+    value interned = parse(src, parse_options().intern_strings(true));
+    ensure_eq(parse(src), interned);
+    ensure(&interned[0]["kind"].as_string() == &interned[1]["kind"].as_string());
+    ensure(&interned[0]["name"].as_string() == &interned[1]["name"].as_string());
+    ensure(&parse(src)[0]["kind"].as_string() != &interned[1]["kind"].as_string());
+}
+
+TEST_PARSE(intern_strings_still_reports_errors)
+{
+    auto options = parse_options()
+                   .intern_strings(true)
+                   .string_encoding(parse_options::encoding::utf8_strict)
+                   .failure_mode(parse_options::on_error::collect_all);
+    try
+    {
+        parse("[\"\xe4\", \"\xe4\"]", options);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(2U, err.problems().size());
+    }
+}
+
+TEST_PARSE(borrow_input)
+{
+    std::string src = R"({"plain": "some text", "escaped": "tab\there", "unicode": "aé", "": ""})";
+    value borrowed = parse(src, parse_options().borrow_input(true));
+    ensure_eq(parse(src), borrowed);
+    
+    string_view plain = borrowed["plain"].as_string_view();
+    ensure(plain.data() >= src.data() && plain.data() < src.data() + src.size());
+    ensure(borrowed["escaped"].as_string_view().data() < src.data()
+        || borrowed["escaped"].as_string_view().data() >= src.data() + src.size()
+          );
+    ensure_eq("tab\there", borrowed["escaped"].as_string());
+    
+    // as_string makes a single copy and keeps it
+    const std::string& copied = borrowed["plain"].as_string();
+    ensure_eq("some text", copied);
+    ensure(&copied == &borrowed["plain"].as_string());
+}
+
+TEST_PARSE(borrow_input_copies_are_independent)
+{
+    value copy;
+    {
+        std::string src = R"(["first", ["second"]])";
+        value borrowed = parse(src, parse_options().borrow_input(true));
+        copy = borrowed;
+        std::fill(src.begin(), src.end(), 'x');
+    }
+    ensure_eq(array({ "first", array({ "second" }) }), copy);
+}
+
+TEST_PARSE(borrow_input_ignored_for_streams)
+{
+    std::istringstream stream(R"(["streamed"])");
+    value x = parse(stream, parse_options().borrow_input(true));
+    ensure_eq(string_view("streamed"), x[0].as_string_view());
+}
+
+static std::string make_records_document(std::size_t count)
+{
+    std::ostringstream os;
+    os << "[\n";
+    for (std::size_t idx = 0; idx < count; ++idx)
+    {
+        if (idx > 0)
+            os << ",\n";
+        os << "  {\"id\": " << idx << ", \"name\": \"record \\\"" << idx << "\\\", [not] {an} array\\\\\", "
+           << "\"tags\": [\"a,b\", [], {}, " << idx * 0.5 << "], \"ok\": " << (idx % 2 ? "true" : "null") << "}";
+    }
+    os << "\n]\n";
+    return os.str();
+}
+
+TEST_PARSE(parallel_matches_sequential)
+{
+    std::string src = make_records_document(1000);
+    value expected = parse(src);
+    ensure_eq(1000U, expected.size());
+    ensure_eq(expected, parse_parallel(src, parse_options(), 4, 1));
+    ensure_eq(expected, parse_parallel(src, parse_options(), 3, 500));
+    ensure_eq(expected, parse_parallel(src, parse_options().borrow_input(true).intern_strings(true), 4));
+    ensure_eq(expected, parse_parallel(src));
+}
+
+TEST_PARSE(parallel_falls_back)
+{
+    for (const char* src : { "[]", "[1]", "[1, 2, 3,]", "[1, /* one, */ 2]", "{\"a\": [1, 2]}", "\"[1, 2]\"",
+                             "  [[1, 2], [3, 4]]  ", "[\"a\\\"\", \"]\", [\"b\"]]"
+                           }
+        )
+    {
+        ensure_eq(parse(src), parse_parallel(src, parse_options(), 4, 1));
+    }
+
+    ensure_eq(array({ 1, 2 }), parse_parallel("[1, 2] 3", parse_options().complete_parse(false), 4, 1));
+    ensure_throws(parse_error, parse_parallel("[1, 2] 3", parse_options(), 4, 1));
+    ensure_throws(parse_error, parse_parallel("[[1], [2]]", parse_options().max_structure_depth(2), 4, 1));
+    ensure_throws(parse_error, parse_parallel("[1, \"2]", parse_options(), 4, 1));
+}
+
+TEST_PARSE(parallel_problem_locations)
+{
+    std::string src = make_records_document(600);
+    src.replace(src.find("\"id\": 450"), 9, "\"id\": 45x");
+    src.replace(src.find("\"id\": 20,"), 9, "\"id\": 2 3");
+
+    for (auto mode : { parse_options::on_error::fail_immediately, parse_options::on_error::collect_all })
+    {
+        auto options = parse_options().failure_mode(mode);
+        parse_error::problem_list expected;
+        try
+        {
+            parse(src, options);
+        }
+        catch (const parse_error& err)
+        {
+            expected = err.problems();
+        }
+        ensure(!expected.empty());
+
+        try
+        {
+            parse_parallel(src, options, 4, 1);
+            ensure(false);
+        }
+        catch (const parse_error& err)
+        {
+            ensure_eq(expected.size(), err.problems().size());
+            for (std::size_t idx = 0; idx < expected.size(); ++idx)
+            {
+                ensure_eq(expected[idx].line(),      err.problems()[idx].line());
+                ensure_eq(expected[idx].column(),    err.problems()[idx].column());
+                ensure_eq(expected[idx].character(), err.problems()[idx].character());
+                ensure_eq(expected[idx].message(),   err.problems()[idx].message());
+            }
+        }
+    }
+
+    auto ignore = parse_options().failure_mode(parse_options::on_error::ignore);
+    ensure_eq(parse(src, ignore), parse_parallel(src, ignore, 4, 1));
+}
+
+TEST_PARSE(file_matches_stream)
+{
+    for (const char* name : { "canada.json", "paths.json", "blns.json" })
+    {
+        std::ifstream stream(jsonv_test::test_path(name).c_str());
+        ensure_eq(parse(stream), parse_file(jsonv_test::test_path(name)));
+    }
+    
+    value borrowed = parse_file(jsonv_test::test_path("paths.json"), parse_options().borrow_input(true));
+    std::ifstream stream(jsonv_test::test_path("paths.json").c_str());
+    ensure_eq(parse(stream), borrowed);
+}
+
+TEST_PARSE(file_problems)
+{
+    ensure_throws(std::system_error, parse_file(jsonv_test::test_path("no-such-file.json")));
+    
+    std::string path = "parse_file_problems.json";
+    auto remove_file = jsonv::detail::on_scope_exit([&path] { std::remove(path.c_str()); });
+    {
+        std::ofstream file(path.c_str());
+        file << "[1,\n 2 3]";
+    }
+    try
+    {
+        parse_file(path);
+        ensure(false);
+    }
+    catch (const parse_error& err)
+    {
+        ensure_eq(2U, err.problems().front().line());
+        ensure_eq(4U, err.problems().front().column());
+    }
+    
+    {
+        std::ofstream file(path.c_str());
+    }
+    ensure_throws(parse_error, parse_file(path));
+}
@@ -12,6 +12,7 @@
 
 #include "test.hpp"
 
+#include <jsonv/encode.hpp>
 #include <jsonv/parse.hpp>
 #include <jsonv/serialization_builder.hpp>
 #include <jsonv/serialization_optional.hpp>
@@ -728,4 +729,309 @@ TEST(serialization_builder_duplicate_type_actions)
     ensure_eq(3, serde(1, builder));
 }
 
+static formats extract_json_formats()
+{
+    return formats_builder()
+            .type<person>()
+                .member("firstname",        &person::firstname)
+                    .alternate_name("first_name")
+                .member("middle_name",      &person::middle_name)
+                    .default_value(nullopt)
+                .member("lastname",         &person::lastname)
+                .member("age",              &person::age)
+                    .default_value(20)
+                    .default_on_null()
+                .member("favorite_numbers", &person::favorite_numbers)
+                    .default_value(std::set<long>())
+                .member("winning_numbers",  &person::winning_numbers)
+                    .default_value([] (const extraction_context& cxt, const value& val)
+                                   {
+                                       return cxt.extract_sub<std::vector<long>>(val, "lucky");
+                                   }
+                                  )
+            .register_optional<optional<std::string>>()
+            #if JSONV_COMPILER_SUPPORTS_TEMPLATE_TEMPLATES
+            .register_containers<long, std::set, std::vector>()
+            #else
+            .register_container<std::set<long>>()
+            .register_container<std::vector<long>>()
+            #endif
+            .register_container<std::vector<person>>()
+            .compose_checked(formats::defaults())
+        ;
+}
+
+TEST(serialization_builder_extract_json)
+{
+    formats fmt = extract_json_formats();
+    std::string input = R"([
+            {
+                "firstname": "Bob",
+                "ignored": { "deeply": [ { "nested": "stuff" }, [1, 2, [3]] ] },
+                "lastname": "Builder",
+                "age": 29,
+                "favorite_numbers": [3, 1, 2],
+                "lucky": [7]
+            },
+            {
+                "first_name": "Alternate",
+                "firstname": "Preferred",
+                "middle_name": "M",
+                "lastname": "Person",
+                "age": null,
+                "winning_numbers": [4, 5]
+            },
+            { "first_name": "Only", "lastname": "Alternate", "lucky": [], "age": 1 }
+        ])";
+
+    auto people = extract_json<std::vector<person>>(input, fmt);
+    ensure_eq(3U, people.size());
+    ensure_eq(person("Bob", "Builder", 29, { 1, 2, 3 }, { 7 }), people[0]);
+    ensure_eq(person("Preferred", "Person", 20, {}, { 4, 5 }, std::string("M")), people[1]);
+    ensure_eq(person("Only", "Alternate", 1), people[2]);
+    ensure(extract<std::vector<person>>(parse(input), fmt) == people);
+
+    ensure_eq(person("Bob", "Builder", 29), extract_json<person>(to_string(to_json(person("Bob", "Builder", 29), fmt)),
+                                                                 fmt
+                                                                )
+             );
+}
+
+TEST(serialization_builder_extract_json_pre_extract)
+{
+    std::set<std::string> extra_keys;
+    auto extra_keys_handler = [&extra_keys] (const extraction_context&, const value&, std::set<std::string> x)
+                              {
+                                  extra_keys = std::move(x);
+                              };
+
+    formats fmt = formats_builder()
+                    .type<person>()
+                        .member("firstname", &person::firstname)
+                        .member("lastname",  &person::lastname)
+                        .member("age",       &person::age)
+                        .on_extract_extra_keys(extra_keys_handler)
+                    .compose_checked(formats::defaults())
+                ;
+
+    person q = extract_json<person>(R"({ "firstname": "Bob", "lastname": "Builder", "age": 29, "extra": [1] })", fmt);
+    ensure_eq(person("Bob", "Builder", 29), q);
+    ensure(extra_keys == std::set<std::string>({ "extra" }));
+}
+
+TEST(serialization_builder_extract_json_errors)
+{
+    formats fmt = extract_json_formats();
+
+    try
+    {
+        extract_json<std::vector<person>>(R"([{ "firstname": "a", "lastname": "b", "lucky": [] }, { "firstname": 5 }])",
+                                          fmt
+                                         );
+        ensure(false);
+    }
+    catch (const extraction_error& err)
+    {
+        ensure_eq(path::create("[1].firstname"), err.path());
+    }
+
+    try
+    {
+        extract_json<person>("{ \"firstname\": \"bad\\escape\", \"lastname\": \"b\", \"lucky\": [] }", fmt);
+        ensure(false);
+    }
+    catch (const extraction_error& err)
+    {
+        ensure_eq(path::create(".firstname"), err.path());
+    }
+
+    // unused members are not decoded
+    ensure_eq(person("a", "b", 20),
+              extract_json<person>(R"({ "firstname": "a", "lastname": "b", "winning_numbers": [], "x": "\e" })", fmt)
+             );
+    ensure_throws(parse_error, extract_json<person>(R"({ "firstname": "a", "lastname": "b" )", fmt));
+    ensure_throws(extraction_error, extract_json<person>(R"([1, 2])", fmt));
+}
+
+/** Check that \a input extracts to \a expected with both \c extract and \c extract_json. **/
+static void check_shared_keys(const formats& fmt, const char* input, const std::pair<int, int>& expected)
+{
+    if (extract<std::pair<int, int>>(parse(input), fmt) != expected
+     || extract_json<std::pair<int, int>>(input, fmt) != expected
+       )
+        throw std::runtime_error(std::string("Wrong extraction of ") + input);
+}
+
+TEST(serialization_builder_shared_keys)
+{
+    using my_pair = std::pair<int, int>;
+
+    std::set<std::string> extra_keys;
+    formats fmt = formats_builder()
+                    .type<my_pair>()
+                        .member("a", &my_pair::first)
+                            .alternate_name("x")
+                        .member("b", &my_pair::second)
+                            .alternate_name("a")
+                            .default_value(0)
+                    .compose_checked(formats::defaults())
+                ;
+    formats checked_fmt = formats_builder()
+                            .type<my_pair>()
+                                .member("a", &my_pair::first)
+                                    .alternate_name("x")
+                                .member("b", &my_pair::second)
+                                    .alternate_name("a")
+                                .on_extract_extra_keys([&extra_keys] (const extraction_context&,
+                                                                      const value&,
+                                                                      std::set<std::string> x
+                                                                     )
+                                                       {
+                                                           extra_keys = std::move(x);
+                                                       }
+                                                      )
+                            .compose_checked(formats::defaults())
+                        ;
+
+    check_shared_keys(fmt, R"({ "a": 1, "b": 2 })", { 1, 2 });
+    check_shared_keys(fmt, R"({ "a": 1 })",         { 1, 1 });
+    check_shared_keys(fmt, R"({ "x": 3, "a": 4 })", { 4, 4 });
+    check_shared_keys(fmt, R"({ "x": 3, "z": 4 })", { 3, 0 });
+
+    // parse does not allow duplicate keys, but a lazy_document finds the first one
+    ensure(my_pair(6, 5) == extract_json<my_pair>(R"({ "b": 5, "x": 6, "b": 7 })", fmt));
+
+    ensure(my_pair(1, 2) == extract<my_pair>(parse(R"({ "x": 1, "y": 2, "b": 2, "z": 3 })"), checked_fmt));
+    ensure(extra_keys == std::set<std::string>({ "y", "z" }));
+}
+
+/** Encode \a from with \c to_encoder and check it comes out the same as encoding the result of \c to_json. **/
+template <typename T>
+static std::string check_to_encoder(const T& from, const formats& fmt, const version& ver = version())
+{
+    serialization_context context(fmt, ver);
+    std::ostringstream expected;
+    expected << context.to_json(from);
+
+    std::ostringstream actual;
+    ostream_encoder encoder(actual);
+    event_writer writer(encoder);
+    context.to_encoder(from, writer);
+
+    if (expected.str() != actual.str())
+        throw std::runtime_error("to_encoder wrote " + actual.str() + " instead of " + expected.str());
+    return actual.str();
+}
+
+TEST(serialization_builder_to_encoder)
+{
+    using my_pair = std::pair<int, int>;
+
+    formats fmt = formats_builder()
+                    .type<person>()
+                        .member("lastname",         &person::lastname)
+                        .member("firstname",        &person::firstname)
+                        .member("middle_name",      &person::middle_name)
+                        .member("age",              &person::age)
+                            .since({ 2, 0 })
+                        .member("favorite_numbers", &person::favorite_numbers)
+                        .member("winning_numbers",  &person::winning_numbers)
+                    .type<my_pair>()
+                        .member("b", &my_pair::second)
+                            .encode_if([] (const serialization_context&, int x) { return x > 0; })
+                        .member("b", &my_pair::first)
+                        .member("a", &my_pair::first)
+                    .enum_type<x::ring>("ring", { { x::ring::fire, "fire" }, { x::ring::wind, "wind" } })
+                    .register_optional<optional<std::string>>()
+                    #if JSONV_COMPILER_SUPPORTS_TEMPLATE_TEMPLATES
+                    .register_containers<long, std::set, std::vector>()
+                    #else
+                    .register_container<std::set<long>>()
+                    .register_container<std::vector<long>>()
+                    #endif
+                    .register_container<std::vector<person>>()
+                    .register_container<std::vector<my_pair>>()
+                    .register_container<std::vector<x::ring>>()
+                    .compose_checked(formats::defaults())
+                ;
+
+    std::vector<person> people = { person("Bob", "Builder", 29, { 3, 1 }, { 5 }, std::string("the")),
+                                   person("Someone", "Else", 40)
+                                 };
+    ensure_eq(R"([{"age":29,"favorite_numbers":[1,3],"firstname":"Bob","lastname":"Builder","middle_name":"the",)"
+              R"("winning_numbers":[5]},{"age":40,"favorite_numbers":[],"firstname":"Someone","lastname":"Else",)"
+              R"("middle_name":null,"winning_numbers":[]}])",
+              check_to_encoder(people, fmt)
+             );
+    check_to_encoder(people, fmt, version(1, 0));
+    ensure_eq(R"([{"a":1,"b":2},{"a":3,"b":3}])", check_to_encoder(std::vector<my_pair>({ { 1, 2 }, { 3, -4 } }), fmt));
+    ensure_eq(R"(["wind","fire",null])",
+              check_to_encoder(std::vector<x::ring>({ x::ring::wind, x::ring::fire, x::ring::heart }), fmt)
+             );
+    check_to_encoder(std::string("plain"), fmt);
+    check_to_encoder(3.5, fmt);
+
+    std::ostringstream direct;
+    ostream_encoder encoder(direct);
+    to_encoder(people, encoder, fmt);
+    ensure_eq(to_string(to_json(people, fmt)), direct.str());
+}
+
+TEST(serialization_builder_static_type)
+{
+    using my_pair = std::pair<int, int>;
+
+    formats dynamic_fmt = formats_builder()
+                            .type<person>()
+                                .member("lastname",    &person::lastname)
+                                .member("firstname",   &person::firstname)
+                                .member("middle_name", &person::middle_name)
+                                .member("age",         &person::age)
+                            .register_optional<optional<std::string>>()
+                            .register_container<std::vector<person>>()
+                            .compose_checked(formats::defaults())
+                        ;
+    formats static_fmt = formats_builder()
+                            .static_type<person>(JSONV_STATIC_MEMBER(person, lastname,    "lastname"),
+                                                 JSONV_STATIC_MEMBER(person, firstname,   "firstname"),
+                                                 JSONV_STATIC_MEMBER(person, middle_name, "middle_name"),
+                                                 JSONV_STATIC_MEMBER(person, age,         "age")
+                                                )
+                            .static_type<my_pair>(JSONV_STATIC_MEMBER(my_pair, second, "b"),
+                                                  JSONV_STATIC_MEMBER(my_pair, first,  "b"),
+                                                  JSONV_STATIC_MEMBER(my_pair, first,  "a")
+                                                 )
+                            .register_optional<optional<std::string>>()
+                            .register_container<std::vector<person>>()
+                            .compose_checked(formats::defaults())
+                        ;
+
+    std::vector<person> people = { person("Bob", "Builder", 29, {}, {}, std::string("the")),
+                                   person("Someone", "Else", 40)
+                                 };
+    value encoded = to_json(people, static_fmt);
+    ensure_eq(to_json(people, dynamic_fmt), encoded);
+    ensure(people == extract<std::vector<person>>(encoded, static_fmt));
+    ensure(people == extract_json<std::vector<person>>(to_string(encoded), static_fmt));
+    check_to_encoder(people, static_fmt);
+
+    // missing keys are left alone, just like a member without a default_value
+    person partial = extract_json<person>(R"({ "firstname": "Only", "age": 3, "extra": [] })", static_fmt);
+    ensure_eq(person("Only", "", 3), partial);
+    ensure_eq(partial, extract<person>(parse(R"({ "firstname": "Only", "age": 3, "extra": [] })"), static_fmt));
+
+    ensure_eq(R"({"a":1,"b":2})", check_to_encoder(my_pair(1, 2), static_fmt));
+
+    try
+    {
+        extract_json<std::vector<person>>(R"([{ "firstname": "a" }, { "age": "old" }])", static_fmt);
+        ensure(false);
+    }
+    catch (const extraction_error& err)
+    {
+        ensure_eq(path::create("[1].age"), err.path());
+    }
+    ensure_throws(extraction_error, extract<person>(array({ 1 }), static_fmt));
+}
+
 }
@@ -287,4 +287,57 @@ TEST(serialize_basics)
     }
 }
 
+TEST(formats_flatten)
+{
+    static auto five = make_extractor([] (const value&) { return std::int16_t(5); });
+    static auto six  = make_extractor([] (const value&) { return std::int16_t(6); });
+
+    formats bottom = formats::compose({ formats::defaults() });
+    formats middle = formats::compose({ bottom });
+    middle.register_extractor(&five);
+    formats shadowed;
+    shadowed.register_extractor(&six);
+    formats top = formats::compose({ formats::compose({ middle }), shadowed, middle });
+    {
+        formats owner;
+        owner.register_extractor(std::unique_ptr<extractor>(new extractor_construction<my_thing>()));
+        top = formats::compose({ top, owner });
+    }
+
+    formats flat = top.flatten();
+    ensure(flat != top);
+    value thing = parse(R"({ "a": 1, "b": 2, "c": "thing" })");
+    ensure_eq(my_thing(1, 2, "thing"), extract<my_thing>(thing, flat));
+    ensure_eq(5, extract<std::int16_t>(thing, flat));
+    ensure_eq("x", extract<std::string>("x", flat));
+    ensure_eq(to_json(std::string("x"), top), to_json(std::string("x"), flat));
+
+    // later changes to the bases are not seen
+    bottom.register_extractor(my_thing::get_extractor());
+    ensure_throws(no_extractor, flat.get_extractor(typeid(unassociated)));
+    static auto instance = make_extractor([] (const value&) { return unassociated(); });
+    bottom.register_extractor(&instance);
+    ensure_eq(5, extract<std::int16_t>(thing, top));
+    top.get_extractor(typeid(unassociated));
+    ensure_throws(no_extractor, flat.get_extractor(typeid(unassociated)));
+}
+
+TEST(extractor_handle)
+{
+    formats fmts = formats::compose({ formats::defaults() });
+    fmts.register_extractor(my_thing::get_extractor());
+    extraction_context context(fmts);
+
+    extractor_handle<my_thing> handle(fmts);
+    ensure(&handle.get() == my_thing::get_extractor());
+    ensure_eq(my_thing(1, 2, "thing"), handle.extract(context, parse(R"({ "a": 1, "b": 2, "c": "thing" })")));
+
+    std::string text = R"([{ "a": 3, "b": 4, "c": "other" }])";
+    lazy_document doc(text);
+    ensure_eq(my_thing(3, 4, "other"), handle.extract(context, doc.root().at(0)));
+
+    ensure_throws(extraction_error, handle.extract(context, parse(R"({ "a": 1 })")));
+    ensure_throws(no_extractor, extractor_handle<unassociated>{ fmts });
+}
+
 }
@@ -10,10 +10,14 @@
 **/
 #include "test.hpp"
 
+#include <jsonv/parse.hpp>
 #include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/scope_exit.hpp>
 
 #include <random>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 namespace jsonv_test
 {
@@ -62,4 +66,69 @@ TEST(tokenizer_string)
     ensure_eq(found.text, "\"true\"");
 }
 
+static std::vector<std::pair<std::string, token_kind>> all_tokens(tokenizer& tokens)
+{
+    std::vector<std::pair<std::string, token_kind>> out;
+    while (tokens.next())
+        out.emplace_back(std::string(tokens.current().text), tokens.current().kind);
+    return out;
+}
+
+static const std::string streaming_source =
+    R"({ "a long string which will not fit in the buffer, with \"escapes\" and \\ things": [ 12345.678e9, -0.5, )"
+    R"(true, false, null, "", {}, [], 1234567890123456789 ], /* a comment */ "k":"v" , "tru": tru })";
+
+TEST(tokenizer_stream_small_buffers)
+{
+    tokenizer in_memory(streaming_source);
+    auto expected = all_tokens(in_memory);
+    
+    auto orig_size = tokenizer::min_buffer_size();
+    auto restore   = jsonv::detail::on_scope_exit([orig_size] { tokenizer::set_min_buffer_size(orig_size); });
+    for (tokenizer::size_type buffer_size = 1; buffer_size < 40; ++buffer_size)
+    {
+        tokenizer::set_min_buffer_size(buffer_size);
+        std::istringstream istream(streaming_source);
+        tokenizer streamed(istream);
+        ensure(all_tokens(streamed) == expected);
+    }
+}
+
+TEST(tokenizer_stream_current_survives_end)
+{
+    std::istringstream istream("[1, 2]");
+    tokenizer tokens(istream);
+    while (tokens.next())
+    { }
+    ensure_eq(tokens.current().text, "]");
+    ensure(!tokens.next());
+    ensure_eq(tokens.current().text, "]");
+}
+
+TEST(tokenizer_stream_parse_small_buffers)
+{
+    std::string source = R"([ { "id": 1, "name": "first", "tags": [ "x", "y" ] }, { "id": 2, "name": "second", "ok": true } ])";
+    value expected = parse(source);
+    
+    auto orig_size = tokenizer::min_buffer_size();
+    auto restore   = jsonv::detail::on_scope_exit([orig_size] { tokenizer::set_min_buffer_size(orig_size); });
+    for (tokenizer::size_type buffer_size = 1; buffer_size < 20; ++buffer_size)
+    {
+        tokenizer::set_min_buffer_size(buffer_size);
+        std::istringstream istream(source);
+        ensure_eq(expected, parse(istream));
+    }
+}
+
+TEST(tokenizer_stream_multiple_documents)
+{
+    std::istringstream istream(R"({"a": 1} [2, 3] "four")");
+    tokenizer tokens(istream);
+    tokens.buffer_reserve(3);
+    auto options = parse_options().complete_parse(false);
+    ensure_eq(parse(tokens, options), parse(R"({"a": 1})"));
+    ensure_eq(parse(tokens, options), parse("[2, 3]"));
+    ensure_eq(parse(tokens, options), value("four"));
+}
+
 }
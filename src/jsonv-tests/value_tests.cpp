@@ -145,3 +145,19 @@ TEST(hash_set_operations)
     ensure_eq(0U, set.count(str));
     ensure_eq(5U, set.size());
 }
+
+TEST(string_copies_share_storage)
+{
+    jsonv::value a = std::string(100, 'x');
+    jsonv::value b = a;
+    ensure(&a.as_string() == &b.as_string());
+    
+    b = "something else";
+    ensure_eq(std::string(100, 'x'), a.as_string());
+    ensure_eq("something else", b.as_string());
+    
+    std::string source(50, 'y');
+    const char* source_chars = source.data();
+    jsonv::value moved(std::move(source));
+    ensure(moved.as_string().data() == source_chars);
+}
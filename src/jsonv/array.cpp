@@ -20,10 +20,7 @@ namespace jsonv
 
 value array()
 {
-    value x;
-    x._data.array = new detail::array_impl;
-    x._kind = jsonv::kind::array;
-    return x;
+    return detail::make_array(new_delete_resource());
 }
 
 value array(std::initializer_list<value> source)
@@ -36,6 +33,14 @@ value array(std::initializer_list<value> source)
 namespace detail
 {
 
+value make_array(memory_resource* resource)
+{
+    value x;
+    x._data.array = create_in<array_impl>(resource, resource);
+    x._kind = jsonv::kind::array;
+    return x;
+}
+
 value::size_type array_impl::size() const
 {
     return _values.size();
@@ -132,7 +137,7 @@ void value::pop_back()
 void value::push_front(value item)
 {
     check_type(jsonv::kind::array, kind());
-    _data.array->_values.emplace_front(std::move(item));
+    _data.array->_values.emplace(_data.array->_values.begin(), std::move(item));
 }
 
 void value::pop_front()
@@ -140,7 +145,7 @@ void value::pop_front()
     check_type(jsonv::kind::array, kind());
     if (_data.array->_values.empty())
         throw std::logic_error("Cannot pop from empty array");
-    _data.array->_values.pop_front();
+    _data.array->_values.erase(_data.array->_values.begin());
 }
 
 value::array_iterator value::insert(const_array_iterator position, value item)
@@ -15,7 +15,7 @@
 #include <jsonv/value.hpp>
 #include <jsonv/detail.hpp>
 
-#include <deque>
+#include <vector>
 
 namespace jsonv
 {
@@ -26,9 +26,20 @@ class JSONV_LOCAL array_impl :
         public cloneable<array_impl>
 {
 public:
-    typedef std::deque<jsonv::value> array_type;
+    typedef std::vector<jsonv::value, resource_allocator<jsonv::value>> array_type;
     
 public:
+    explicit array_impl(memory_resource* resource = new_delete_resource()) :
+            _values(array_type::allocator_type(resource))
+    { }
+    
+    array_impl(const array_impl&) = default;
+    
+    memory_resource* resource() const
+    {
+        return _values.get_allocator().resource();
+    }
+    
     value::size_type size() const;
     
     bool empty() const;
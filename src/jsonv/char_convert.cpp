@@ -23,6 +23,7 @@
 #include <stdexcept>
 
 #include "detail/fixed_map.hpp"
+#include "detail/simd_scan.hpp"
 
 namespace jsonv
 {
@@ -186,12 +187,13 @@ static bool utf8_extract_code(const char* c, unsigned length, char bitmask, char
 
 static const char hex_codes[] = "0123456789abcdef";
 
-static void to_hex(std::ostream& stream, uint16_t code)
+template <typename TOutput>
+static void to_hex(TOutput& output, uint16_t code)
 {
     for (int pos = 3; pos >= 0; --pos)
     {
         uint16_t local_code = (code >> (4 * pos)) & uint16_t(0x000f);
-        stream << hex_codes[local_code];
+        output.push_back(hex_codes[local_code]);
     }
 }
 
@@ -208,16 +210,47 @@ static void utf16_create_surrogates(char32_t codepoint, uint16_t* high, uint16_t
     *low  = uint16_t(val & 0x03ff) | 0xdc00;
 }
 
-std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii)
+/** Adapts an \c std::ostream to the subset of the \c std::string interface \c string_encode_to uses. **/
+struct ostream_output
+{
+    std::ostream& stream;
+    
+    void append(const char* data, std::size_t length)
+    {
+        stream.write(data, std::streamsize(length));
+    }
+    
+    void push_back(char c)
+    {
+        stream.put(c);
+    }
+};
+
+template <typename TOutput>
+static void string_encode_to(TOutput& output, string_view source, bool ensure_ascii)
 {
     typedef string_view::size_type size_type;
     
+    const simd_scanner& scanner = active_simd_scanner();
     for (size_type idx = 0, source_size = source.size(); idx < source_size; /* incremented inline */)
     {
+        // Most strings are mostly plain characters, so copy them in runs
+        size_type run_end = size_type(scanner.find_encode_special(source.data() + idx, source.data() + source_size)
+                                      - source.data()
+                                     );
+        if (run_end != idx)
+        {
+            output.append(source.data() + idx, run_end - idx);
+            idx = run_end;
+            if (idx == source_size)
+                break;
+        }
+        
         const char& current = source[idx];
         if (const char* replacement = find_encoding(current))
         {
-            stream << "\\" << *replacement;
+            output.push_back('\\');
+            output.push_back(*replacement);
             ++idx;
         }
         else
@@ -228,7 +261,7 @@ std::ostream& string_encode(std::ostream& stream, string_view source, bool ensur
             
             if (!needs_unicode_escaping(current))
             {
-                stream << current;
+                output.push_back(current);
             }
             else
             {
@@ -247,33 +280,43 @@ std::ostream& string_encode(std::ostream& stream, string_view source, bool ensur
                 // if the input string is valid UTF-8, let it pass through
                 if (valid_utf8 && !ensure_ascii)
                 {
-                    stream.write(&current, length);
+                    output.append(&current, length);
                 }
                 // basic multilingual plane points are encoded in hex
                 else if (code < 0x10000)
                 {
-                    stream << "\\u";
-                    to_hex(stream, uint16_t(code));
+                    output.append("\\u", 2);
+                    to_hex(output, uint16_t(code));
                 }
                 // Codepoints not in the basic multilingual plane must be encoded as surrogate pairs
                 else
                 {
                     uint16_t high, low;
                     utf16_create_surrogates(code, &high, &low);
-                    stream << "\\u";
-                    to_hex(stream, high);
-                    stream << "\\u";
-                    to_hex(stream, low);
+                    output.append("\\u", 2);
+                    to_hex(output, high);
+                    output.append("\\u", 2);
+                    to_hex(output, low);
                 }
             }
             
             idx += length;
         }
     }
-    
+}
+
+std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii)
+{
+    ostream_output output = { stream };
+    string_encode_to(output, source, ensure_ascii);
     return stream;
 }
 
+void string_encode(std::string& output, string_view source, bool ensure_ascii)
+{
+    string_encode_to(output, source, ensure_ascii);
+}
+
 static uint16_t from_hex_digit(char c, std::size_t idx)
 {
     switch (c)
@@ -419,146 +462,147 @@ std::string string_decode(string_view source)
 {
     typedef std::string::size_type size_type;
     
+    // decoding never makes a string longer, so this is the only allocation (and the result has no wasted capacity when
+    // there are no escapes)
     std::string output;
+    output.reserve(source.size());
     const char* last_pushed_src = source.data();
-    size_type utf8_sequence_start = 0;
-    unsigned remaining_utf8_sequence = 0;
+    const simd_scanner& scanner = active_simd_scanner();
     
     for (size_type idx = 0; idx < source.size(); /* incremented inline */)
     {
+        // Printable ASCII is copied as-is, so skip to the next thing which needs a closer look -- nothing is copied
+        // until an escape sequence is found or the end is reached
+        const char* source_end = source.data() + source.size();
+        idx = size_type(scanner.find_decode_special(source.data() + idx, source_end) - source.data());
+        if (idx == source.size())
+            break;
+        
         const char& current = source[idx];
-        if (remaining_utf8_sequence == 0)
+        if (current == '\\')
         {
-            if (current == '\\')
+            output.append(last_pushed_src, source.data()+idx);
+            
+            const char& next = source[idx + 1];
+            if (const char* replacement = find_decoding(next))
             {
-                output.append(last_pushed_src, source.data()+idx);
+                output += *replacement;
+                idx += 2;
+            }
+            else if (next == 'u')
+            {
+                if (idx + 6 > source.size())
+                    throw decode_error(idx, "unterminated Unicode escape sequence (must have 4 hex characters)");
+                uint16_t hexval = from_hex(&source[idx + 2], idx + 2);
                 
-                const char& next = source[idx + 1];
-                if (const char* replacement = find_decoding(next))
-                {
-                    output += *replacement;
-                    idx += 2;
-                }
-                else if (next == 'u')
+                if (encoding == parse_options::encoding::cesu8 || hexval < 0xd800U || hexval > 0xdfffU)
                 {
-                    if (idx + 6 > source.size())
-                        throw decode_error(idx, "unterminated Unicode escape sequence (must have 4 hex characters)");
-                    uint16_t hexval = from_hex(&source[idx + 2], idx + 2);
+                    utf8_append_code(output, hexval);
                     
-                    if (encoding == parse_options::encoding::cesu8 || hexval < 0xd800U || hexval > 0xdfffU)
-                    {
-                        utf8_append_code(output, hexval);
-                        
-                        idx += 6;
-                    }
-                    // numeric encoding is in U+d800 - U+dfff with UTF-8 output, so deal with surrogate pairing...
-                    else
-                    {
-                        auto surrogateString = [&] () { return std::string(source.data()+idx, 6); };
-                        if (  idx + 12 > source.size()
-                           || idx +  8 > source.size()
-                           || source[idx + 6] != '\\'
-                           || source[idx + 7] != 'u'
-                           )
-                            throw decode_error(idx, std::string("unpaired high surrogate (") + surrogateString() + ")");
-                        uint16_t hexlowval = from_hex(&source[idx + 8], idx + 8);
-                        char32_t codepoint;
-                        if (!utf16_combine_surrogates(hexval, hexlowval, &codepoint))
-                            throw decode_error(idx, std::string("unpaired high surrogate (") + surrogateString() + ")");
-                        
-                        utf8_append_code(output, codepoint);
-                        
-                        idx += 12;
-                    }
+                    idx += 6;
                 }
+                // numeric encoding is in U+d800 - U+dfff with UTF-8 output, so deal with surrogate pairing...
                 else
                 {
-                    throw decode_error(idx, std::string("Unknown escape character: ") + next);
-                    //output += '?'; Maybe better solution if we don't want to throw
-                    //++idx;
+                    auto surrogateString = [&] () { return std::string(source.data()+idx, 6); };
+                    if (  idx + 12 > source.size()
+                       || idx +  8 > source.size()
+                       || source[idx + 6] != '\\'
+                       || source[idx + 7] != 'u'
+                       )
+                        throw decode_error(idx, std::string("unpaired high surrogate (") + surrogateString() + ")");
+                    uint16_t hexlowval = from_hex(&source[idx + 8], idx + 8);
+                    char32_t codepoint;
+                    if (!utf16_combine_surrogates(hexval, hexlowval, &codepoint))
+                        throw decode_error(idx, std::string("unpaired high surrogate (") + surrogateString() + ")");
+                    
+                    utf8_append_code(output, codepoint);
+                    
+                    idx += 12;
                 }
-                
-                last_pushed_src = source.data() + idx;
             }
-            else 
+            else
             {
-                unsigned utf8_length;
-                char utf8_bitmask;
-                utf8_extract_info(current,
-                                  utf8_length,
-                                  utf8_bitmask,
-                                  [&idx] (char x)
-                                  {
-                                      std::ostringstream os;
-                                      os << "Invalid UTF-8 code point: \\x"
-                                         << std::hex << std::setw(2) << static_cast<int>(x) << std::dec << '.';
-                                      throw decode_error(idx, os.str());
-                                  }
-                                 );
-                
-                if (utf8_length > 1)
+                throw decode_error(idx, std::string("Unknown escape character: ") + next);
+                //output += '?'; Maybe better solution if we don't want to throw
+                //++idx;
+            }
+            
+            last_pushed_src = source.data() + idx;
+        }
+        else 
+        {
+            unsigned utf8_length;
+            char utf8_bitmask;
+            utf8_extract_info(current,
+                              utf8_length,
+                              utf8_bitmask,
+                              [&idx] (char x)
+                              {
+                                  std::ostringstream os;
+                                  os << "Invalid UTF-8 code point: \\x"
+                                     << std::hex << std::setw(2) << static_cast<int>(x) << std::dec << '.';
+                                  throw decode_error(idx, os.str());
+                              }
+                             );
+            
+            if (utf8_length > 1)
+            {
+                // Check the whole multi-byte sequence at once instead of coming back through the scanner for each byte
+                size_type utf8_sequence_start = idx;
+                size_type utf8_sequence_end   = idx + utf8_length;
+                for (++idx; idx < utf8_sequence_end && idx < source.size(); ++idx)
                 {
-                    utf8_sequence_start = idx;
-                    remaining_utf8_sequence = utf8_length - 1;
-                    ++idx;
+                    // not on a UTF8 continuation, even though we should be...
+                    if (!is_utf8_sequence_continuation(source[idx]))
+                    {
+                        std::ostringstream os;
+                        os << "Invalid UTF-8 multi-byte sequence in source: \"";
+                        for (size_type pos = utf8_sequence_start; pos <= idx; ++pos)
+                            os << "\\x" << std::setw(2) << std::hex << static_cast<int>(source[pos]);
+                        os << std::dec << "\". ";
+                        size_type remaining_utf8_sequence = utf8_sequence_end - idx;
+                        os << "The sequence should continue for " << remaining_utf8_sequence
+                           << " character" << (remaining_utf8_sequence == 1 ? "" : "s");
+                        throw decode_error(idx, os.str());
+                    }
                 }
-                else if (require_printable && !std::isprint(current))
+                
+                if (encoding != parse_options::encoding::cesu8 && utf8_sequence_end > source.size())
                 {
                     std::ostringstream os;
-                    os << "Unprintable character found in input: ";
-                    switch (current)
+                    os << "unterminated UTF-8 sequence at end of string: \"";
+                    os << std::hex;
+                    for (size_type pos = utf8_sequence_start; pos < source.size(); ++pos)
                     {
-                    case '\t': os << "\\t (tab)"; break;
-                    case '\b': os << "\\b (backspace)"; break;
-                    case '\f': os << "\\f (formfeed)"; break;
-                    case '\n': os << "\\n (newline)"; break;
-                    case '\r': os << "\\r (carriage return)"; break;
-                    default:   os << "\\x" << std::hex << std::setw(2) << static_cast<int>(current) << std::dec; break;
+                        os << "\\x" << std::setfill('0') << std::setw(2) << unsigned(int(source[pos]));
                     }
-                    throw decode_error(idx, os.str());
-                }
-                else
-                {
-                    ++idx;
+                    os << '\"';
+                    throw decode_error(utf8_sequence_start, os.str());
                 }
             }
-        }
-        // remaining_utf8_sequence > 0
-        else
-        {
-            if (is_utf8_sequence_continuation(current))
+            else if (require_printable && !std::isprint(current))
             {
-                ++idx;
-                --remaining_utf8_sequence;
+                std::ostringstream os;
+                os << "Unprintable character found in input: ";
+                switch (current)
+                {
+                case '\t': os << "\\t (tab)"; break;
+                case '\b': os << "\\b (backspace)"; break;
+                case '\f': os << "\\f (formfeed)"; break;
+                case '\n': os << "\\n (newline)"; break;
+                case '\r': os << "\\r (carriage return)"; break;
+                default:   os << "\\x" << std::hex << std::setw(2) << static_cast<int>(current) << std::dec; break;
+                }
+                throw decode_error(idx, os.str());
             }
-            // not on a UTF8 continuation, even though we should be...
             else
             {
-                std::ostringstream os;
-                os << "Invalid UTF-8 multi-byte sequence in source: \"";
-                for (size_type pos = utf8_sequence_start; pos <= idx; ++pos)
-                    os << "\\x" << std::setw(2) << std::hex << static_cast<int>(source[pos]);
-                os << std::dec << "\". ";
-                os << "The sequence should continue for " << remaining_utf8_sequence
-                   << " character" << (remaining_utf8_sequence == 1 ? "" : "s");
-                throw decode_error(idx, os.str());
+                ++idx;
             }
         }
     }
     
-    if (encoding != parse_options::encoding::cesu8 && remaining_utf8_sequence > 0)
-    {
-        std::ostringstream os;
-        os << "unterminated UTF-8 sequence at end of string: \"";
-        os << std::hex;
-        for (size_type idx = utf8_sequence_start; idx < source.size(); ++idx)
-        {
-            os << "\\x" << std::setfill('0') << std::setw(2) << unsigned(int(source[idx]));
-        }
-        os << '\"';
-        throw decode_error(utf8_sequence_start, os.str());
-    }
-    
     output.append(last_pushed_src, source.end());
     return output;
 }
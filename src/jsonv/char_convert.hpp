@@ -46,12 +46,29 @@ private:
 **/
 std::ostream& string_encode(std::ostream& stream, string_view source, bool ensure_ascii = true);
 
+/** Like the \c std::ostream version of \c string_encode, but appends to \a output. **/
+void string_encode(std::string& output, string_view source, bool ensure_ascii = true);
+
 /** A function that decodes an over the wire character sequence \c source into a C++ string. **/
 typedef std::string (*string_decode_fn)(string_view source);
 
 /** Get a string decoding function for the given output \a encoding. **/
 string_decode_fn get_string_decoder(parse_options::encoding encoding);
 
+/** Is the \a text of a string token (including the surrounding quotes) exactly what it decodes to? Only printable ASCII
+ *  without escapes qualifies, since that comes out unchanged from every \c parse_options::encoding.
+**/
+inline bool needs_no_decoding(string_view text)
+{
+    if (text.size() < 2)
+        return false;
+    
+    for (const char c : text.substr(1, text.size() - 2))
+        if (c < ' ' || c > '~' || c == '\\')
+            return false;
+    return true;
+}
+
 /** Convert the UTF-8 encoded \a source into a UTF-16 encoded \c std::wstring. **/
 std::wstring convert_to_wide(string_view source);
 
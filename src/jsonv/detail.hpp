@@ -11,28 +11,152 @@
 #ifndef __JSONV_DETAIL_HPP_INCLUDED__
 #define __JSONV_DETAIL_HPP_INCLUDED__
 
+#include <jsonv/memory_resource.hpp>
 #include <jsonv/value.hpp>
 #include <jsonv/string_view.hpp>
 
+#include <atomic>
+#include <new>
+#include <utility>
+
 namespace jsonv
 {
 namespace detail
 {
 
+/** Create a \c T with memory from \a resource. The \c T must be able to report the \a resource it came from through a
+ *  \c resource() member function so \c destroy can give the memory back.
+**/
+template <typename T, typename... TArgs>
+T* create_in(memory_resource* resource, TArgs&&... args)
+{
+    void* p = resource->allocate(sizeof(T), alignof(T));
+    try
+    {
+        return new(p) T(std::forward<TArgs>(args)...);
+    }
+    catch (...)
+    {
+        resource->deallocate(p, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+/** Destroy a \c T created with \c create_in. **/
+template <typename T>
+void destroy(T* p) noexcept
+{
+    memory_resource* resource = p->resource();
+    p->~T();
+    resource->deallocate(p, sizeof(T), alignof(T));
+}
+
+/** Copies of a value are always heap-backed, even if the source lives in some other \c memory_resource. The container
+ *  members pick \c new_delete_resource through \c resource_allocator::select_on_container_copy_construction.
+**/
 template <typename T>
 struct cloneable
 {
     T* clone() const
     {
-        return new T(*static_cast<const T*>(this));
+        return create_in<T>(new_delete_resource(), *static_cast<const T*>(this));
     }
 };
 
-class string_impl :
-        public cloneable<string_impl>
+/** The storage for a \c kind::string. The contents never change once created, so copies of a \c value share a single
+ *  \c string_impl by reference counting instead of copying the characters.
+ *  
+ *  An instance either owns its characters or borrows them from a buffer somebody else keeps alive (see
+ *  \c parse_options::borrow_input). A borrowed instance only makes an \c std::string the first time one is asked for.
+**/
+class string_impl
 {
 public:
-    std::string _string;
+    struct borrow_tag { };
+    
+public:
+    explicit string_impl(std::string source, memory_resource* resource = new_delete_resource()) :
+            _string(std::move(source)),
+            _view(_string),
+            _borrowed(false),
+            _resource(resource),
+            _references(1),
+            _copy(nullptr)
+    { }
+    
+    string_impl(borrow_tag, string_view source, memory_resource* resource) :
+            _view(source),
+            _borrowed(true),
+            _resource(resource),
+            _references(1),
+            _copy(nullptr)
+    { }
+    
+    ~string_impl() noexcept
+    {
+        delete _copy.load(std::memory_order_relaxed);
+    }
+    
+    string_impl(const string_impl&) = delete;
+    string_impl& operator=(const string_impl&) = delete;
+    
+    /** Get an instance with the same contents for a copy of a \c value. Heap-backed instances are shared by reference,
+     *  while borrowed ones and ones from any other \c memory_resource are copied to the heap so the copy does not
+     *  depend on anything the original did.
+    **/
+    string_impl* share()
+    {
+        if (_borrowed || !_resource->is_equal(*new_delete_resource()))
+            return create_in<string_impl>(new_delete_resource(), std::string(_view.data(), _view.size()));
+        
+        _references.fetch_add(1, std::memory_order_relaxed);
+        return this;
+    }
+    
+    /** Drop a reference to this instance, destroying it if it was the last one. **/
+    void release()
+    {
+        if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            destroy(this);
+    }
+    
+    memory_resource* resource() const
+    {
+        return _resource;
+    }
+    
+    string_view view() const
+    {
+        return _view;
+    }
+    
+    /** Get the contents as an \c std::string. For a borrowed instance, the first call makes the copy. Instances are
+     *  shared between threads, so racing callers agree on a single copy with a compare-and-swap.
+    **/
+    const std::string& str() const
+    {
+        if (!_borrowed)
+            return _string;
+        
+        const std::string* copy = _copy.load(std::memory_order_acquire);
+        if (!copy)
+        {
+            auto created = new std::string(_view.data(), _view.size());
+            if (_copy.compare_exchange_strong(copy, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                copy = created;
+            else
+                delete created;
+        }
+        return *copy;
+    }
+    
+private:
+    const std::string                       _string;
+    const string_view                       _view;
+    const bool                              _borrowed;
+    memory_resource*                        _resource;
+    std::atomic<std::size_t>                _references;
+    mutable std::atomic<const std::string*> _copy;
 };
 
 }
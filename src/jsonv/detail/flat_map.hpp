@@ -0,0 +1,371 @@
+/** \file jsonv/detail/flat_map.hpp
+ *  A sorted, contiguous associative container used for object storage when \c JSONV_OBJECT_USE_FLAT_MAP is enabled.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__
+#define __JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** A map which keeps its entries sorted by key in a single contiguous buffer. Lookups are a binary search over
+ *  contiguous memory and iteration is a linear walk, which is much friendlier to the cache than the node-per-entry
+ *  layout of \c std::map for the small objects typically found in JSON. The cost is that inserting or erasing an entry
+ *  moves the entries after it and invalidates all iterators and references into the map.
+ *
+ *  The interface is the subset of \c std::map that \c object_impl needs. Iterators are plain pointers to the
+ *  \c std::pair<const TKey, TValue> entries, so the public \c object_iterator types stay simple. Since the keys really
+ *  are \c const, an entry can not be moved in place -- shifting entries around copies their keys (while the values are
+ *  moved). Building a map from sorted input with the hinted \c insert only ever appends, so it never shifts anything.
+ *
+ *  If copying a key throws while entries are being shifted, the entries after it are lost (the map is still valid).
+**/
+template <typename TKey, typename TValue, typename TAllocator = std::allocator<std::pair<const TKey, TValue>>>
+class flat_map
+{
+public:
+    using key_type       = TKey;
+    using mapped_type    = TValue;
+    using value_type     = std::pair<const TKey, TValue>;
+    using size_type      = std::size_t;
+    using iterator       = value_type*;
+    using const_iterator = const value_type*;
+    using allocator_type = typename std::allocator_traits<TAllocator>::template rebind_alloc<value_type>;
+
+private:
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+public:
+    flat_map() = default;
+
+    explicit flat_map(const allocator_type& alloc) :
+            _alloc(alloc)
+    { }
+
+    flat_map(const flat_map& src) :
+            _alloc(alloc_traits::select_on_container_copy_construction(src._alloc))
+    {
+        try
+        {
+            assign(src.begin(), src.end());
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    flat_map(flat_map&& src) noexcept :
+            _alloc(src._alloc),
+            _data(src._data),
+            _size(src._size),
+            _capacity(src._capacity)
+    {
+        src._data     = nullptr;
+        src._size     = 0;
+        src._capacity = 0;
+    }
+
+    flat_map& operator=(const flat_map& src)
+    {
+        if (this != &src)
+        {
+            clear();
+            assign(src.begin(), src.end());
+        }
+        return *this;
+    }
+
+    ~flat_map() noexcept
+    {
+        release();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return _alloc;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_type size() const
+    {
+        return _size;
+    }
+
+    iterator begin()
+    {
+        return _data;
+    }
+
+    const_iterator begin() const
+    {
+        return _data;
+    }
+
+    iterator end()
+    {
+        return _data + _size;
+    }
+
+    const_iterator end() const
+    {
+        return _data + _size;
+    }
+
+    iterator find(const key_type& key)
+    {
+        iterator iter = lower_bound(key);
+        return (iter != end() && !(key < iter->first)) ? iter : end();
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        return const_cast<flat_map&>(*this).find(key);
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return find(key) == end() ? 0U : 1U;
+    }
+
+    mapped_type& at(const key_type& key)
+    {
+        iterator iter = find(key);
+        if (iter == end())
+            throw std::out_of_range("flat_map::at");
+        return iter->second;
+    }
+
+    const mapped_type& at(const key_type& key) const
+    {
+        return const_cast<flat_map&>(*this).at(key);
+    }
+
+    mapped_type& operator[](const key_type& key)
+    {
+        iterator iter = lower_bound(key);
+        if (iter == end() || key < iter->first)
+            iter = emplace_at(iter, key, mapped_type());
+        return iter->second;
+    }
+
+    mapped_type& operator[](key_type&& key)
+    {
+        iterator iter = lower_bound(key);
+        if (iter == end() || key < iter->first)
+            iter = emplace_at(iter, std::move(key), mapped_type());
+        return iter->second;
+    }
+
+    std::pair<iterator, bool> insert(std::pair<TKey, TValue> entry)
+    {
+        iterator iter = lower_bound(entry.first);
+        if (iter != end() && !(entry.first < iter->first))
+            return { iter, false };
+        else
+            return { emplace_at(iter, std::move(entry.first), std::move(entry.second)), true };
+    }
+
+    /** Insert the \a entry, using \a hint as the position if it is correct. This makes building a map from sorted input
+     *  (such as copying another object) linear instead of quadratic.
+    **/
+    iterator insert(const_iterator hint, std::pair<TKey, TValue> entry)
+    {
+        if (  (hint == end() || entry.first < hint->first)
+           && (hint == begin() || (hint - 1)->first < entry.first)
+           )
+        {
+            return emplace_at(hint, std::move(entry.first), std::move(entry.second));
+        }
+        else
+        {
+            return insert(std::move(entry)).first;
+        }
+    }
+
+    size_type erase(const key_type& key)
+    {
+        iterator iter = find(key);
+        if (iter == end())
+            return 0U;
+
+        erase(iter);
+        return 1U;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const size_type offset = size_type(first - begin());
+        const size_type count  = size_type(last - first);
+        if (count == 0)
+            return begin() + offset;
+
+        for (size_type idx = offset; idx + count < _size; ++idx)
+            replace(idx, std::move(_data[idx + count]));
+        destroy_from(_size - count);
+        return begin() + offset;
+    }
+
+    void clear() noexcept
+    {
+        destroy_from(0);
+    }
+
+private:
+    iterator lower_bound(const key_type& key)
+    {
+        return std::lower_bound(begin(), end(), key,
+                                [] (const value_type& entry, const key_type& k) { return entry.first < k; }
+                               );
+    }
+
+    template <typename UKey, typename UValue>
+    iterator emplace_at(const_iterator position, UKey&& key, UValue&& value)
+    {
+        const size_type offset = size_type(position - begin());
+        if (_size == _capacity)
+            grow(offset, std::forward<UKey>(key), std::forward<UValue>(value));
+        else if (offset == _size)
+            construct(_size++, std::forward<UKey>(key), std::forward<UValue>(value));
+        else
+        {
+            // construct the new entry first, so nothing is shifted if that throws
+            value_type entry(std::forward<UKey>(key), std::forward<UValue>(value));
+            construct(_size, std::move(_data[_size - 1]));
+            ++_size;
+            for (size_type idx = _size - 2; idx > offset; --idx)
+                replace(idx, std::move(_data[idx - 1]));
+            replace(offset, std::move(entry));
+        }
+        return begin() + offset;
+    }
+
+    /** Move everything to a larger buffer, putting a new entry made from \a key and \a value at \a offset. **/
+    template <typename UKey, typename UValue>
+    void grow(size_type offset, UKey&& key, UValue&& value)
+    {
+        const size_type new_capacity = _capacity == 0 ? 4U : _capacity * 2U;
+        value_type*     new_data     = alloc_traits::allocate(_alloc, new_capacity);
+        bool            placed       = false;
+        size_type       moved        = 0;
+        try
+        {
+            alloc_traits::construct(_alloc, new_data + offset, std::forward<UKey>(key), std::forward<UValue>(value));
+            placed = true;
+            for (; moved < _size; ++moved)
+                alloc_traits::construct(_alloc, new_data + moved + (moved < offset ? 0 : 1), std::move(_data[moved]));
+        }
+        catch (...)
+        {
+            for (size_type idx = 0; idx < moved; ++idx)
+                alloc_traits::destroy(_alloc, new_data + idx + (idx < offset ? 0 : 1));
+            if (placed)
+                alloc_traits::destroy(_alloc, new_data + offset);
+            alloc_traits::deallocate(_alloc, new_data, new_capacity);
+            throw;
+        }
+
+        const size_type new_size = _size + 1;
+        release();
+        _data     = new_data;
+        _size     = new_size;
+        _capacity = new_capacity;
+    }
+
+    template <typename... TArgs>
+    void construct(size_type idx, TArgs&&... args)
+    {
+        alloc_traits::construct(_alloc, _data + idx, std::forward<TArgs>(args)...);
+    }
+
+    /** Replace the entry at \a idx with one made from \a source. If that throws, everything from \a idx on is lost. **/
+    void replace(size_type idx, value_type&& source)
+    {
+        alloc_traits::destroy(_alloc, _data + idx);
+        try
+        {
+            construct(idx, std::move(source));
+        }
+        catch (...)
+        {
+            // the entry at idx is already gone, so the ones after it can not stay
+            for (size_type after = idx + 1; after < _size; ++after)
+                alloc_traits::destroy(_alloc, _data + after);
+            _size = idx;
+            throw;
+        }
+    }
+
+    /** Destroy the entries from \a idx to the end. **/
+    void destroy_from(size_type idx) noexcept
+    {
+        for (size_type pos = idx; pos < _size; ++pos)
+            alloc_traits::destroy(_alloc, _data + pos);
+        _size = idx;
+    }
+
+    /** Destroy everything and give the buffer back to the allocator. **/
+    void release() noexcept
+    {
+        destroy_from(0);
+        if (_data)
+            alloc_traits::deallocate(_alloc, _data, _capacity);
+        _data     = nullptr;
+        _capacity = 0;
+    }
+
+    /** Copy the entries in [\a first, \a last) into this empty map. **/
+    void assign(const_iterator first, const_iterator last)
+    {
+        const size_type count = size_type(last - first);
+        if (_capacity < count)
+        {
+            release();
+            _data     = alloc_traits::allocate(_alloc, count);
+            _capacity = count;
+        }
+        for (; first != last; ++first)
+        {
+            construct(_size, *first);
+            ++_size;
+        }
+    }
+
+private:
+    allocator_type _alloc;
+    value_type*    _data     = nullptr;
+    size_type      _size     = 0;
+    size_type      _capacity = 0;
+};
+
+}
+}
+
+#endif/*__JSONV_DETAIL_FLAT_MAP_HPP_INCLUDED__*/
@@ -0,0 +1,92 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/mapped_file.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+
+#include <cerrno>
+#include <system_error>
+
+#ifdef _MSC_VER
+#   include <fstream>
+#   include <iterator>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace jsonv
+{
+namespace detail
+{
+
+#ifdef _MSC_VER
+
+mapped_file::mapped_file(const std::string& path) :
+        _data(nullptr),
+        _size(0)
+{
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+        throw std::system_error(errno, std::generic_category(), "Could not open \"" + path + "\"");
+
+    _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+}
+
+mapped_file::~mapped_file() noexcept = default;
+
+#else
+
+mapped_file::mapped_file(const std::string& path) :
+        _data(nullptr),
+        _size(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), "Could not open \"" + path + "\"");
+    auto close_fd = on_scope_exit([fd] { ::close(fd); });
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+        throw std::system_error(errno, std::system_category(), "Could not get the size of \"" + path + "\"");
+
+    // mapping an empty file fails, but there is nothing to map anyway
+    _size = std::size_t(info.st_size);
+    if (_size == 0)
+        return;
+
+    void* mapping = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+        throw std::system_error(errno, std::system_category(), "Could not map \"" + path + "\"");
+    _data = static_cast<const char*>(mapping);
+
+    // only a hint, so failure is not a problem
+    ::madvise(mapping, _size, MADV_SEQUENTIAL);
+}
+
+mapped_file::~mapped_file() noexcept
+{
+    if (_data)
+        ::munmap(const_cast<char*>(_data), _size);
+}
+
+#endif
+
+string_view mapped_file::contents() const
+{
+    return string_view(_data, _size);
+}
+
+}
+}
@@ -0,0 +1,55 @@
+/** \file jsonv/detail/mapped_file.hpp
+ *  Read-only access to the contents of a file without copying them through a stream.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_MAPPED_FILE_HPP_INCLUDED__
+#define __JSONV_DETAIL_MAPPED_FILE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/string_view.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** The contents of a file, memory-mapped read-only where the platform supports it. The kernel is told the mapping will
+ *  be read sequentially, so it can read ahead aggressively. On other platforms, the file is read into memory.
+**/
+class mapped_file
+{
+public:
+    /** Open and map the file at \a path.
+     *
+     *  \throws std::system_error if the file can not be opened or mapped.
+    **/
+    explicit mapped_file(const std::string& path);
+
+    ~mapped_file() noexcept;
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    /** Get the contents of the file, which are valid for as long as this instance is. **/
+    string_view contents() const;
+
+private:
+    const char* _data;
+    std::size_t _size;
+    std::string _buffer;   //!< The contents of the file when it could not be mapped.
+};
+
+}
+}
+
+#endif/*__JSONV_DETAIL_MAPPED_FILE_HPP_INCLUDED__*/
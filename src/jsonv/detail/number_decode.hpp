@@ -0,0 +1,40 @@
+/** \file jsonv/detail/number_decode.hpp
+ *  Conversion of the text of JSON numbers to integers and doubles.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_NUMBER_DECODE_HPP_INCLUDED__
+#define __JSONV_DETAIL_NUMBER_DECODE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+#include <cstdint>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** Decode the \a characters of a \c token_kind::number. This does not depend on the current C locale.
+ *
+ *  Text without a fraction or exponent is an integer if it fits. Non-negative values from 2^63 to 2^64-1 are stored
+ *  as the \c std::int64_t with the same bits. The onus is on the user to know a particular key is in that range.
+ *  Integers too large for 64 bits, and everything with a fraction or exponent, become the nearest \c double.
+ *
+ *  \returns \c kind::integer if \a integer was filled, \c kind::decimal if \a decimal was filled or \c kind::null if
+ *   the text is not a number.
+**/
+kind decode_number(string_view characters, std::int64_t& integer, double& decimal);
+
+}
+}
+
+#endif/*__JSONV_DETAIL_NUMBER_DECODE_HPP_INCLUDED__*/
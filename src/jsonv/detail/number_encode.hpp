@@ -0,0 +1,50 @@
+/** \file jsonv/detail/number_encode.hpp
+ *  Conversion of integers and doubles to the text of JSON numbers.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_NUMBER_ENCODE_HPP_INCLUDED__
+#define __JSONV_DETAIL_NUMBER_ENCODE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** The size of a buffer large enough for any output of \c format_decimal. **/
+static constexpr std::size_t format_decimal_max_length = 32;
+
+/** Write the decimal digits of \a value so they end right before \a end, two at a time.
+ *
+ *  \returns The position of the first character written.
+**/
+char* format_unsigned(char* end, std::uint64_t value);
+
+/** Write the shortest text which reads back as exactly \a value to \a buffer, which must have room for
+ *  \c format_decimal_max_length characters. This does not depend on the current C locale.
+ *
+ *  The layout follows \c printf with \c "%.17g": values whose leading digit is from 10^-4 to 10^16 are written without
+ *  an exponent, anything else is written in scientific notation with at least two exponent digits. Unlike
+ *  \c "%.17g", only as many significant digits as are needed to tell \a value apart from its neighbors are written, so
+ *  \c 0.1 comes out as \c "0.1" instead of \c "0.10000000000000001".
+ *
+ *  \param value The value to write. This must be finite.
+ *  \returns The number of characters written.
+**/
+std::size_t format_decimal(double value, char* buffer);
+
+}
+}
+
+#endif/*__JSONV_DETAIL_NUMBER_ENCODE_HPP_INCLUDED__*/
@@ -0,0 +1,145 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/parallel.hpp>
+
+#include <algorithm>
+#include <system_error>
+
+namespace jsonv
+{
+namespace detail
+{
+
+std::size_t resolve_thread_count(std::size_t requested)
+{
+    if (requested > 0)
+        return requested;
+    else
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+void parallel_for(std::size_t count, std::size_t thread_count, const std::function<void (std::size_t)>& task)
+{
+    thread_pool pool(std::min(thread_count, count));
+    pool.parallel_for(count, task);
+}
+
+thread_pool::thread_pool(std::size_t thread_count) :
+        _thread_count(std::max<std::size_t>(1, thread_count)),
+        _round(0),
+        _busy(0),
+        _stopping(false),
+        _task(nullptr),
+        _count(0),
+        _next(0),
+        _failed(false)
+{ }
+
+thread_pool::~thread_pool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    _round_started.notify_all();
+    for (std::thread& thread : _threads)
+        thread.join();
+}
+
+void thread_pool::start_threads()
+{
+    _threads.reserve(_thread_count - 1);
+    for (std::size_t idx = 1; idx < _thread_count; ++idx)
+    {
+        try
+        {
+            _threads.emplace_back([this] { worker(); });
+        }
+        catch (const std::system_error&)
+        {
+            // make do with the threads which could be started
+            break;
+        }
+    }
+    _thread_count = _threads.size() + 1;
+}
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void (std::size_t)>& task)
+{
+    if (count == 0)
+        return;
+    if (_threads.empty() && _thread_count > 1)
+        start_threads();
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _task   = &task;
+        _count  = count;
+        _next   = 0;
+        _failed = false;
+        _error  = nullptr;
+        _busy   = _threads.size();
+        ++_round;
+    }
+    _round_started.notify_all();
+
+    run_tasks();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> guard(_lock);
+        _round_finished.wait(guard, [this] { return _busy == 0; });
+        _task = nullptr;
+        std::swap(error, _error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void thread_pool::run_tasks()
+{
+    for (std::size_t idx = _next++; idx < _count && !_failed; idx = _next++)
+    {
+        try
+        {
+            (*_task)(idx);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            if (!_error)
+                _error = std::current_exception();
+            _failed = true;
+        }
+    }
+}
+
+void thread_pool::worker()
+{
+    std::size_t                  seen = 0;
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true)
+    {
+        _round_started.wait(guard, [&] { return _stopping || _round != seen; });
+        if (_stopping)
+            return;
+
+        seen = _round;
+        guard.unlock();
+        run_tasks();
+        guard.lock();
+        if (--_busy == 0)
+            _round_finished.notify_one();
+    }
+}
+
+}
+}
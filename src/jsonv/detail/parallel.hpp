@@ -0,0 +1,101 @@
+/** \file jsonv/detail/parallel.hpp
+ *  Helpers for splitting work across threads.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_PARALLEL_HPP_INCLUDED__
+#define __JSONV_DETAIL_PARALLEL_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** Get the number of threads to use when a user asks for \a requested -- 0 means one per hardware thread. **/
+std::size_t resolve_thread_count(std::size_t requested);
+
+/** Call \a task with each index in `[0, count)` using up to \a thread_count threads, one of which is the calling
+ *  thread. Indices are handed out in order, but may complete in any order. This returns when every call has completed.
+ *
+ *  \throws The first exception thrown by \a task, after every other task has finished. Indices not yet handed out when
+ *          the exception was thrown are skipped.
+**/
+void parallel_for(std::size_t count, std::size_t thread_count, const std::function<void (std::size_t)>& task);
+
+/** A set of threads which stay around to run one \c parallel_for after another, so work which comes in rounds (like
+ *  encoding a huge array a window at a time) only starts its threads once. The threads are started by the first
+ *  \c parallel_for and stopped when the pool is destroyed.
+**/
+class thread_pool
+{
+public:
+    /** Create a pool which runs tasks on up to \a thread_count threads, one of which is the thread calling
+     *  \c parallel_for.
+    **/
+    explicit thread_pool(std::size_t thread_count);
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() noexcept;
+
+    /** The number of threads tasks are run on, including the calling thread. **/
+    std::size_t size() const
+    {
+        return _thread_count;
+    }
+
+    /** Call \a task with each index in `[0, count)`, the same way as the free \c parallel_for does. Only one thread may
+     *  call this at a time.
+     *
+     *  \throws The first exception thrown by \a task, after every other task has finished.
+    **/
+    void parallel_for(std::size_t count, const std::function<void (std::size_t)>& task);
+
+private:
+    void start_threads();
+
+    /** Run tasks from the current round until there are none left. **/
+    void run_tasks();
+
+    void worker();
+
+private:
+    std::size_t              _thread_count;
+    std::vector<std::thread> _threads;
+
+    std::mutex               _lock;
+    std::condition_variable  _round_started;
+    std::condition_variable  _round_finished;
+    std::size_t              _round;   //!< Incremented when a round of tasks is started.
+    std::size_t              _busy;    //!< The number of \c _threads still working on the current round.
+    bool                     _stopping;
+
+    const std::function<void (std::size_t)>* _task;
+    std::size_t                              _count;
+    std::atomic<std::size_t>                 _next;
+    std::atomic<bool>                        _failed;
+    std::exception_ptr                       _error;
+};
+
+}
+}
+
+#endif/*__JSONV_DETAIL_PARALLEL_HPP_INCLUDED__*/
@@ -0,0 +1,339 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/simd_scan.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#   define JSONV_SIMD_X86 1
+#   include <immintrin.h>
+#else
+#   define JSONV_SIMD_X86 0
+#endif
+
+namespace jsonv
+{
+namespace detail
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// scalar                                                                                                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool is_whitespace(char c)
+{
+    switch (c)
+    {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static const char* scalar_find_quote_or_backslash(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+        if (*begin == '\"' || *begin == '\\')
+            return begin;
+    return end;
+}
+
+static const char* scalar_skip_whitespace(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+        if (!is_whitespace(*begin))
+            return begin;
+    return end;
+}
+
+static bool is_encode_special(char c)
+{
+    return c < ' ' || c > '~' || c == '\"' || c == '\\' || c == '/';
+}
+
+static const char* scalar_find_encode_special(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+        if (is_encode_special(*begin))
+            return begin;
+    return end;
+}
+
+static const char* scalar_find_decode_special(const char* begin, const char* end)
+{
+    for ( ; begin != end; ++begin)
+        if (*begin < ' ' || *begin > '~' || *begin == '\\')
+            return begin;
+    return end;
+}
+
+static const simd_scanner scalar_scanner =
+{
+    scalar_find_quote_or_backslash,
+    scalar_skip_whitespace,
+    scalar_find_encode_special,
+    scalar_find_decode_special,
+};
+
+#if JSONV_SIMD_X86
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2                                                                                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* sse2_find_quote_or_backslash(const char* begin, const char* end)
+{
+    const __m128i quote     = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                                                                _mm_cmpeq_epi8(block, backslash)
+                                                               )
+                                                  )
+                                );
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return scalar_find_quote_or_backslash(begin, end);
+}
+
+static const char* sse2_skip_whitespace(const char* begin, const char* end)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab   = _mm_set1_epi8('\t');
+    const __m128i cr    = _mm_set1_epi8('\r');
+    const __m128i lf    = _mm_set1_epi8('\n');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i ws    = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(block, cr),    _mm_cmpeq_epi8(block, lf))
+                                    );
+        unsigned mask = ~unsigned(_mm_movemask_epi8(ws)) & 0xffffU;
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return scalar_skip_whitespace(begin, end);
+}
+
+static const char* sse2_find_encode_special(const char* begin, const char* end)
+{
+    // bytes are compared as signed, so everything with the high bit set is also less than a space
+    const __m128i space     = _mm_set1_epi8(' ');
+    const __m128i del       = _mm_set1_epi8('\x7f');
+    const __m128i quote     = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash     = _mm_set1_epi8('/');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del)),
+                                       _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                                                                 _mm_cmpeq_epi8(block, backslash)
+                                                                ),
+                                                    _mm_cmpeq_epi8(block, slash)
+                                                   )
+                                      );
+        unsigned mask = unsigned(_mm_movemask_epi8(special));
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return scalar_find_encode_special(begin, end);
+}
+
+static const char* sse2_find_decode_special(const char* begin, const char* end)
+{
+    const __m128i space     = _mm_set1_epi8(' ');
+    const __m128i del       = _mm_set1_epi8('\x7f');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for ( ; end - begin >= 16; begin += 16)
+    {
+        __m128i block   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del)),
+                                       _mm_cmpeq_epi8(block, backslash)
+                                      );
+        unsigned mask = unsigned(_mm_movemask_epi8(special));
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return scalar_find_decode_special(begin, end);
+}
+
+static const simd_scanner sse2_scanner =
+{
+    sse2_find_quote_or_backslash,
+    sse2_skip_whitespace,
+    sse2_find_encode_special,
+    sse2_find_decode_special,
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2                                                                                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2")))
+static const char* avx2_find_quote_or_backslash(const char* begin, const char* end)
+{
+    const __m256i quote     = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote),
+                                                                      _mm256_cmpeq_epi8(block, backslash)
+                                                                     )
+                                                     )
+                                );
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return sse2_find_quote_or_backslash(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* avx2_skip_whitespace(const char* begin, const char* end)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab   = _mm256_set1_epi8('\t');
+    const __m256i cr    = _mm256_set1_epi8('\r');
+    const __m256i lf    = _mm256_set1_epi8('\n');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i ws    = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(block, cr),    _mm256_cmpeq_epi8(block, lf))
+                                       );
+        unsigned mask = ~unsigned(_mm256_movemask_epi8(ws));
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return sse2_skip_whitespace(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* avx2_find_encode_special(const char* begin, const char* end)
+{
+    // bytes are compared as signed, so everything with the high bit set is also less than a space
+    const __m256i space     = _mm256_set1_epi8(' ');
+    const __m256i del       = _mm256_set1_epi8('\x7f');
+    const __m256i quote     = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i slash     = _mm256_set1_epi8('/');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi8(space, block),
+                                                          _mm256_cmpeq_epi8(block, del)
+                                                         ),
+                                          _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote),
+                                                                          _mm256_cmpeq_epi8(block, backslash)
+                                                                         ),
+                                                          _mm256_cmpeq_epi8(block, slash)
+                                                         )
+                                         );
+        unsigned mask = unsigned(_mm256_movemask_epi8(special));
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return sse2_find_encode_special(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* avx2_find_decode_special(const char* begin, const char* end)
+{
+    const __m256i space     = _mm256_set1_epi8(' ');
+    const __m256i del       = _mm256_set1_epi8('\x7f');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    for ( ; end - begin >= 32; begin += 32)
+    {
+        __m256i block   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi8(space, block),
+                                                          _mm256_cmpeq_epi8(block, del)
+                                                         ),
+                                          _mm256_cmpeq_epi8(block, backslash)
+                                         );
+        unsigned mask = unsigned(_mm256_movemask_epi8(special));
+        if (mask)
+            return begin + __builtin_ctz(mask);
+    }
+    return sse2_find_decode_special(begin, end);
+}
+
+static const simd_scanner avx2_scanner =
+{
+    avx2_find_quote_or_backslash,
+    avx2_skip_whitespace,
+    avx2_find_encode_special,
+    avx2_find_decode_special,
+};
+
+#endif/*JSONV_SIMD_X86*/
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// dispatch                                                                                                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static simd_level detect_simd_level()
+{
+#if JSONV_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return simd_level::avx2;
+    else
+        return simd_level::sse2;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+simd_level max_simd_level()
+{
+    static const simd_level instance = detect_simd_level();
+    return instance;
+}
+
+const simd_scanner& get_simd_scanner(simd_level level)
+{
+    if (level > max_simd_level())
+        level = max_simd_level();
+
+    switch (level)
+    {
+#if JSONV_SIMD_X86
+    case simd_level::avx2: return avx2_scanner;
+    case simd_level::sse2: return sse2_scanner;
+#endif
+    case simd_level::scalar:
+    default:
+        return scalar_scanner;
+    }
+}
+
+const simd_scanner& active_simd_scanner()
+{
+    static const simd_scanner& instance = get_simd_scanner(max_simd_level());
+    return instance;
+}
+
+}
+}
@@ -0,0 +1,81 @@
+/** \file jsonv/detail/simd_scan.hpp
+ *  Vectorized scanning of character ranges for the tokenizer and string codecs.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_SIMD_SCAN_HPP_INCLUDED__
+#define __JSONV_DETAIL_SIMD_SCAN_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** The instruction set a \c simd_scanner uses. These are ordered from least to most capable. **/
+enum class simd_level : unsigned char
+{
+    /** Plain C++ -- one byte at a time. **/
+    scalar,
+    /** 16 bytes at a time with SSE2 (always available on x86-64). **/
+    sse2,
+    /** 32 bytes at a time with AVX2. **/
+    avx2,
+};
+
+/** A table of scanning functions for a particular \c simd_level. Every function in the table behaves identically to
+ *  its \c simd_level::scalar counterpart -- the only difference is speed.
+**/
+struct simd_scanner
+{
+    /** Find the first character in `[begin, end)` which is either \c '"' or \c '\\'.
+     *
+     *  \returns A pointer to the found character or \a end if there is no such character.
+    **/
+    const char* (*find_quote_or_backslash)(const char* begin, const char* end);
+
+    /** Find the first character in `[begin, end)` which is not JSON whitespace (space, tab, carriage return or line
+     *  feed).
+     *
+     *  \returns A pointer to the found character or \a end if the entire range is whitespace.
+    **/
+    const char* (*skip_whitespace)(const char* begin, const char* end);
+
+    /** Find the first character in `[begin, end)` which \c string_encode can not copy to the output as-is. That is
+     *  anything outside of printable ASCII (control characters, \c DEL and every byte of a multi-byte UTF-8 sequence),
+     *  \c '"', \c '\\' and \c '/'.
+     *
+     *  \returns A pointer to the found character or \a end if the entire range can be copied.
+    **/
+    const char* (*find_encode_special)(const char* begin, const char* end);
+
+    /** Find the first character in `[begin, end)` which \c string_decode can not copy to the output without looking
+     *  closer. That is anything outside of printable ASCII and \c '\\'.
+     *
+     *  \returns A pointer to the found character or \a end if the entire range can be copied.
+    **/
+    const char* (*find_decode_special)(const char* begin, const char* end);
+};
+
+/** Get the most capable \c simd_level the running processor supports. This is determined once on first call. **/
+simd_level max_simd_level();
+
+/** Get the scanner for the given \a level. If the processor does not support \a level, the scanner for
+ *  \c max_simd_level is returned instead.
+**/
+const simd_scanner& get_simd_scanner(simd_level level);
+
+/** Get the scanner for \c max_simd_level. **/
+const simd_scanner& active_simd_scanner();
+
+}
+}
+
+#endif/*__JSONV_DETAIL_SIMD_SCAN_HPP_INCLUDED__*/
@@ -0,0 +1,69 @@
+/** \file
+ *  
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/detail/simple_decode.hpp>
+#include <jsonv/memory_resource.hpp>
+#include <jsonv/detail/number_decode.hpp>
+
+#include "../char_convert.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace jsonv
+{
+namespace detail
+{
+
+bool decode_simple(string_view text, kind recorded, const parse_options& options, value& out)
+{
+    switch (recorded)
+    {
+    case kind::integer:
+    {
+        if (options.number_encoding() == parse_options::numbers::strict && text.size() > 1U && text[0] == '0')
+            return false;
+
+        std::int64_t integer;
+        double       decimal;
+        switch (decode_number(text, integer, decimal))
+        {
+        case kind::integer:
+            out = integer;
+            return true;
+        case kind::decimal:
+            out = decimal;
+            return true;
+        default:
+            return false;
+        }
+    }
+    case kind::string:
+        if (options.resource() != new_delete_resource() || options.borrow_input() || !needs_no_decoding(text))
+            return false;
+        out = std::string(text.substr(1, text.size() - 2));
+        return true;
+    case kind::boolean:
+        if (text != "true" && text != "false")
+            return false;
+        out = text == "true";
+        return true;
+    case kind::null:
+        if (text != "null")
+            return false;
+        out = null;
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+}
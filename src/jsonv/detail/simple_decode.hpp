@@ -0,0 +1,37 @@
+/** \file jsonv/detail/simple_decode.hpp
+ *  Decoding of single leaf values without going through \c parse.
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#ifndef __JSONV_DETAIL_SIMPLE_DECODE_HPP_INCLUDED__
+#define __JSONV_DETAIL_SIMPLE_DECODE_HPP_INCLUDED__
+
+#include <jsonv/config.hpp>
+#include <jsonv/parse.hpp>
+#include <jsonv/string_view.hpp>
+#include <jsonv/value.hpp>
+
+namespace jsonv
+{
+namespace detail
+{
+
+/** Decode the \a text of a number, string or literal without going through \c parse when that is sure to give the same
+ *  result, which is most of the time. This is the common case for \c extract_json, which decodes one leaf at a time.
+ *
+ *  \param recorded The \c kind the token was recorded as when the document was scanned.
+ *
+ *  \returns \c true if \a out was filled; \c false if the text has to go through \c parse.
+**/
+bool decode_simple(string_view text, kind recorded, const parse_options& options, value& out);
+
+}
+}
+
+#endif/*__JSONV_DETAIL_SIMPLE_DECODE_HPP_INCLUDED__*/
@@ -9,6 +9,7 @@
  *  \author Travis Gockel (travis@gockelhut.com)
 **/
 #include <jsonv/detail/token_patterns.hpp>
+#include <jsonv/detail/simd_scan.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -325,28 +326,32 @@ static match_result match_string(const char* begin, const char* end, token_kind&
     assert(*begin == '\"');
     
     kind = token_kind::string;
-    length = 1;
+    const simd_scanner& scanner = active_simd_scanner();
     
-    while (true)
+    for (const char* pos = begin + 1; /* inline */; )
     {
-        if (begin + length == end)
-            return match_result::unmatched;
+        pos = scanner.find_quote_or_backslash(pos, end);
+        length = std::size_t(pos - begin);
         
-        if (begin[length] == '\"')
+        if (pos == end)
+        {
+            return match_result::unmatched;
+        }
+        else if (*pos == '\"')
         {
             ++length;
             return match_result::complete;
         }
-        else if (begin[length] == '\\')
+        else if (pos + 1 == end)
         {
-            if (begin + length + 1 == end)
-                return match_result::unmatched;
-            else
-                length += 2;
+            // backslash as the final character -- the escaped character might be in input we have not seen yet
+            ++length;
+            return match_result::unmatched;
         }
         else
         {
-            ++length;
+            // skip the backslash and whatever it escapes
+            pos += 2;
         }
     }
 }
@@ -386,20 +391,8 @@ static match_result match_simple_string(const char* begin, const char* end, toke
 
 static match_result match_whitespace(const char* begin, const char* end, token_kind& kind, std::size_t& length)
 {
-    kind = token_kind::whitespace;
-    for (length = 0; begin != end; ++length, ++begin)
-    {
-        switch (*begin)
-        {
-        case ' ':
-        case '\t':
-        case '\r':
-        case '\n':
-            continue;
-        default:
-            return match_result::complete;
-        }
-    }
+    kind   = token_kind::whitespace;
+    length = std::size_t(active_simd_scanner().skip_whitespace(begin, end) - begin);
     return match_result::complete;
 }
 
@@ -12,9 +12,17 @@
 #include <jsonv/encode.hpp>
 #include <jsonv/value.hpp>
 
+#include <jsonv/detail/number_encode.hpp>
+#include <jsonv/detail/parallel.hpp>
+
+#include "char_convert.hpp"
 #include "detail.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
 
 namespace jsonv
 {
@@ -74,11 +82,133 @@ void encoder::encode(const value& source)
         write_object_end();
         break;
     case kind::string:
-        write_string(source.as_string());
+        write_string(source.as_string_view());
         break;
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// event_writer                                                                                                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+event_writer::event_writer(encoder& out) :
+        _out(out),
+        _after_key(false),
+        _done(false)
+{ }
+
+event_writer::~event_writer() noexcept = default;
+
+void event_writer::before_value()
+{
+    if (_after_key)
+    {
+        _after_key = false;
+    }
+    else if (_open.empty())
+    {
+        if (_done)
+            throw std::logic_error("Only one value can be written at the top level");
+        _done = true;
+    }
+    else if (_open.back() == state::array)
+    {
+        _out.write_array_delimiter();
+    }
+    else if (_open.back() == state::empty_array)
+    {
+        _open.back() = state::array;
+    }
+    else
+    {
+        throw std::logic_error("Values in an object must come after a key");
+    }
+}
+
+void event_writer::value(const jsonv::value& source)
+{
+    before_value();
+    _out.encode(source);
+}
+
+void event_writer::null()
+{
+    before_value();
+    _out.write_null();
+}
+
+void event_writer::boolean(bool value)
+{
+    before_value();
+    _out.write_boolean(value);
+}
+
+void event_writer::integer(std::int64_t value)
+{
+    before_value();
+    _out.write_integer(value);
+}
+
+void event_writer::decimal(double value)
+{
+    before_value();
+    _out.write_decimal(value);
+}
+
+void event_writer::string(string_view value)
+{
+    before_value();
+    _out.write_string(value);
+}
+
+void event_writer::array_begin()
+{
+    before_value();
+    _out.write_array_begin();
+    _open.push_back(state::empty_array);
+}
+
+void event_writer::array_end()
+{
+    end(false);
+    _out.write_array_end();
+}
+
+void event_writer::object_begin()
+{
+    before_value();
+    _out.write_object_begin();
+    _open.push_back(state::empty_object);
+}
+
+void event_writer::key(string_view key)
+{
+    if (_open.empty() || _after_key || _open.back() == state::empty_array || _open.back() == state::array)
+        throw std::logic_error("A key can only be written in an object before its value");
+    
+    if (_open.back() == state::object)
+        _out.write_object_delimiter();
+    else
+        _open.back() = state::object;
+    
+    _out.write_object_key(key);
+    _after_key = true;
+}
+
+void event_writer::object_end()
+{
+    end(true);
+    _out.write_object_end();
+}
+
+void event_writer::end(bool object)
+{
+    bool is_object = !_open.empty() && (_open.back() == state::empty_object || _open.back() == state::object);
+    if (_open.empty() || _after_key || is_object != object)
+        throw std::logic_error(object ? "No object to end" : "No array to end");
+    _open.pop_back();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ostream_encoder                                                                                                    //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,6 +220,11 @@ ostream_encoder::ostream_encoder(std::ostream& output) :
 
 ostream_encoder::~ostream_encoder() noexcept = default;
 
+void ostream_encoder::ensure_ascii(bool value)
+{
+    _ensure_ascii = value;
+}
+
 void ostream_encoder::write_array_begin()
 {
     _output << '[';
@@ -113,10 +248,15 @@ void ostream_encoder::write_boolean(bool value)
 void ostream_encoder::write_decimal(double value)
 {
     if (std::isfinite(value))
-        _output << value;
+    {
+        char buffer[detail::format_decimal_max_length];
+        _output.write(buffer, std::streamsize(detail::format_decimal(value, buffer)));
+    }
     else
+    {
         // non-finite values do not have valid JSON representations, so put it as null
         write_null();
+    }
 }
 
 void ostream_encoder::write_integer(std::int64_t value)
@@ -160,121 +300,655 @@ std::ostream& ostream_encoder::output()
     return _output;
 }
 
+bool ostream_encoder::ensure_ascii() const
+{
+    return _ensure_ascii;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// ostream_pretty_encoder                                                                                             //
+// buffer_encoder                                                                                                     //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ostream_pretty_encoder::ostream_pretty_encoder(std::ostream& output, std::size_t indent_size) :
-        ostream_encoder(output),
+buffer_encoder::buffer_encoder(std::string& output) :
+        _output(output),
+        _chunk_size(0),
+        _ensure_ascii(true),
+        _defer_flush(false)
+{ }
+
+buffer_encoder::buffer_encoder(sink_type sink, std::size_t chunk_size) :
+        _output(_buffer),
+        _sink(std::move(sink)),
+        _chunk_size(chunk_size),
+        _ensure_ascii(true),
+        _defer_flush(false)
+{
+    _buffer.reserve(chunk_size + chunk_size / 4);
+}
+
+buffer_encoder::~buffer_encoder() noexcept
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    { }
+}
+
+void buffer_encoder::ensure_ascii(bool value)
+{
+    _ensure_ascii = value;
+}
+
+void buffer_encoder::flush()
+{
+    if (_sink && !_buffer.empty())
+    {
+        _sink(string_view(_buffer));
+        _buffer.clear();
+    }
+}
+
+void buffer_encoder::flush_if_full()
+{
+    if (_sink && !_defer_flush && _buffer.size() >= _chunk_size)
+        flush();
+}
+
+void buffer_encoder::defer_flush(bool value)
+{
+    _defer_flush = value;
+}
+
+std::string& buffer_encoder::output()
+{
+    return _output;
+}
+
+void buffer_encoder::write_array_begin()
+{
+    _output.push_back('[');
+}
+
+void buffer_encoder::write_array_end()
+{
+    _output.push_back(']');
+    flush_if_full();
+}
+
+void buffer_encoder::write_array_delimiter()
+{
+    _output.push_back(',');
+}
+
+void buffer_encoder::write_boolean(bool value)
+{
+    if (value)
+        _output.append("true", 4);
+    else
+        _output.append("false", 5);
+    flush_if_full();
+}
+
+void buffer_encoder::write_decimal(double value)
+{
+    if (!std::isfinite(value))
+    {
+        // non-finite values do not have valid JSON representations, so put it as null
+        write_null();
+        return;
+    }
+    
+    char buffer[detail::format_decimal_max_length];
+    _output.append(buffer, detail::format_decimal(value, buffer));
+    flush_if_full();
+}
+
+void buffer_encoder::write_integer(std::int64_t value)
+{
+    char buffer[24];
+    char* end   = buffer + sizeof buffer;
+    char* begin = value < 0 ? detail::format_unsigned(end, 0U - std::uint64_t(value))
+                            : detail::format_unsigned(end, std::uint64_t(value));
+    if (value < 0)
+        *--begin = '-';
+    _output.append(begin, end);
+    flush_if_full();
+}
+
+void buffer_encoder::write_null()
+{
+    _output.append("null", 4);
+    flush_if_full();
+}
+
+void buffer_encoder::write_object_begin()
+{
+    _output.push_back('{');
+}
+
+void buffer_encoder::write_object_end()
+{
+    _output.push_back('}');
+    flush_if_full();
+}
+
+void buffer_encoder::write_object_delimiter()
+{
+    _output.push_back(',');
+}
+
+void buffer_encoder::write_object_key(string_view key)
+{
+    write_string(key);
+    _output.push_back(':');
+}
+
+void buffer_encoder::write_string(string_view value)
+{
+    _output.push_back('"');
+    detail::string_encode(_output, value, _ensure_ascii);
+    _output.push_back('"');
+    flush_if_full();
+}
+
+void buffer_encoder::encode_parallel(const value& source, std::size_t thread_count, std::size_t min_entries)
+{
+    thread_count = detail::resolve_thread_count(thread_count);
+    // a subclass might depend on state (like indentation) which a fresh buffer_encoder on another thread would not have
+    if (thread_count <= 1 || typeid(*this) != typeid(buffer_encoder))
+    {
+        encode(source);
+    }
+    else
+    {
+        // the threads are started once and used by every window of every large container in source
+        detail::thread_pool pool(thread_count);
+        encode_parallel_impl(source, pool, std::max<std::size_t>(min_entries, 1));
+    }
+}
+
+void buffer_encoder::encode_parallel_impl(const value& source, detail::thread_pool& pool, std::size_t min_entries)
+{
+    const bool is_array = source.kind() == kind::array;
+    if (!is_array && source.kind() != kind::object)
+    {
+        encode(source);
+        return;
+    }
+
+    auto write_begin = [is_array] (buffer_encoder& out)
+                       {
+                           if (is_array)
+                               out.write_array_begin();
+                           else
+                               out.write_object_begin();
+                       };
+    auto write_delimiter = [is_array] (buffer_encoder& out)
+                           {
+                               if (is_array)
+                                   out.write_array_delimiter();
+                               else
+                                   out.write_object_delimiter();
+                           };
+    auto write_end = [is_array] (buffer_encoder& out)
+                     {
+                         if (is_array)
+                             out.write_array_end();
+                         else
+                             out.write_object_end();
+                     };
+
+    // Small containers are walked the same way encode does, looking for large ones inside
+    if (source.size() < min_entries)
+    {
+        write_begin(*this);
+        bool first = true;
+        if (is_array)
+        {
+            for (const value& sub : source.as_array())
+            {
+                if (!first)
+                    write_array_delimiter();
+                first = false;
+                encode_parallel_impl(sub, pool, min_entries);
+            }
+        }
+        else
+        {
+            for (const value::object_value_type& entry : source.as_object())
+            {
+                if (!first)
+                    write_object_delimiter();
+                first = false;
+                write_object_key(entry.first);
+                encode_parallel_impl(entry.second, pool, min_entries);
+            }
+        }
+        write_end(*this);
+        return;
+    }
+
+    // Gather the entries so the workers can get at any run of them
+    std::vector<string_view>  keys;
+    std::vector<const value*> values;
+    values.reserve(source.size());
+    if (is_array)
+    {
+        for (const value& sub : source.as_array())
+            values.push_back(&sub);
+    }
+    else
+    {
+        keys.reserve(source.size());
+        for (const value::object_value_type& entry : source.as_object())
+        {
+            keys.push_back(entry.first);
+            values.push_back(&entry.second);
+        }
+    }
+
+    // Encode runs of entries a window at a time, so only a window's worth of text is waiting to be put in order
+    const std::size_t count    = values.size();
+    const std::size_t run_size = std::max<std::size_t>(1, std::min<std::size_t>(count / (pool.size() * 4), 1024));
+    const std::size_t window   = pool.size() * 4;
+    std::vector<std::string> texts(window);
+
+    write_begin(*this);
+    for (std::size_t window_start = 0; window_start < count; window_start += run_size * window)
+    {
+        std::size_t runs = std::min(window, (count - window_start + run_size - 1) / run_size);
+        pool.parallel_for(runs, [&] (std::size_t run)
+        {
+            std::string& text = texts[run];
+            text.clear();
+            buffer_encoder worker(text);
+            worker.ensure_ascii(_ensure_ascii);
+
+            std::size_t first = window_start + run * run_size;
+            std::size_t last  = std::min(count, first + run_size);
+            for (std::size_t idx = first; idx < last; ++idx)
+            {
+                if (idx != first)
+                    write_delimiter(worker);
+                if (!is_array)
+                    worker.write_object_key(keys[idx]);
+                worker.encode(*values[idx]);
+            }
+        });
+
+        for (std::size_t run = 0; run < runs; ++run)
+        {
+            if (window_start > 0 || run > 0)
+                write_delimiter(*this);
+            _output.append(texts[run]);
+            flush_if_full();
+        }
+    }
+    write_end(*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// buffer_pretty_encoder                                                                                              //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+buffer_pretty_encoder::buffer_pretty_encoder(std::string& output, std::size_t indent_size) :
+        buffer_encoder(output),
         _indent(0),
         _indent_size(indent_size),
-        _defer_indent(false)
+        _defer_indent(false),
+        _indentation("\n"),
+        _compact_width(0),
+        _compact_start(std::string::npos)
 { }
 
-ostream_pretty_encoder::~ostream_pretty_encoder() noexcept = default;
+buffer_pretty_encoder::buffer_pretty_encoder(sink_type sink, std::size_t indent_size, std::size_t chunk_size) :
+        buffer_encoder(std::move(sink), chunk_size),
+        _indent(0),
+        _indent_size(indent_size),
+        _defer_indent(false),
+        _indentation("\n"),
+        _compact_width(0),
+        _compact_start(std::string::npos)
+{ }
+
+buffer_pretty_encoder::~buffer_pretty_encoder() noexcept = default;
 
-void ostream_pretty_encoder::write_prefix()
+void buffer_pretty_encoder::compact_width(std::size_t width)
+{
+    _compact_width = width;
+}
+
+void buffer_pretty_encoder::write_prefix()
 {
     if (_defer_indent)
     {
-        write_eol();
+        // entries of a container kept on one line are not indented, but they are remembered in case that changes
+        if (_compact_start == std::string::npos)
+            write_eol();
+        else
+            _compact_entries.push_back(output().size());
         _defer_indent = false;
     }
 }
 
-void ostream_pretty_encoder::write_eol()
+void buffer_pretty_encoder::write_eol()
 {
-    output() << std::endl;
-    for (std::size_t x = 0; x < _indent; ++x)
-        output() << ' ';
+    std::size_t length = 1 + _indent;
+    if (_indentation.size() < length)
+        _indentation.resize(length, ' ');
+    output().append(_indentation.data(), length);
 }
 
-void ostream_pretty_encoder::write_array_begin()
+void buffer_pretty_encoder::write_container_begin(char bracket)
 {
+    // only innermost containers are kept on one line
+    if (_compact_start != std::string::npos)
+        expand_compact();
+
     write_prefix();
-    ostream_encoder::write_array_begin();
+    if (_compact_width > 0)
+    {
+        _compact_start = output().size();
+        _compact_entries.clear();
+        defer_flush(true);
+    }
+    output().push_back(bracket);
     _indent += _indent_size;
     _defer_indent = true;
 }
 
-void ostream_pretty_encoder::write_array_end()
+void buffer_pretty_encoder::write_container_end(char bracket)
 {
+    if (_compact_start != std::string::npos)
+    {
+        if (output().size() + 1 - _compact_start <= _compact_width)
+        {
+            _indent -= _indent_size;
+            _defer_indent = false;
+            output().push_back(bracket);
+            _compact_start = std::string::npos;
+            defer_flush(false);
+            flush_if_full();
+            return;
+        }
+        expand_compact();
+    }
+
     _indent -= _indent_size;
     if (!_defer_indent)
     {
         write_eol();
     }
     _defer_indent = false;
-    ostream_encoder::write_array_end();
+    output().push_back(bracket);
+    flush_if_full();
+}
+
+void buffer_pretty_encoder::write_delimiter(bool newline)
+{
+    if (_compact_start != std::string::npos)
+    {
+        output().append(", ", 2);
+        _defer_indent = true;
+        check_compact_width();
+    }
+    else if (newline)
+    {
+        write_prefix();
+        output().push_back(',');
+        write_eol();
+    }
+    else
+    {
+        output().push_back(',');
+        _defer_indent = true;
+    }
+}
+
+void buffer_pretty_encoder::check_compact_width()
+{
+    // there is always at least a closing bracket to come
+    if (_compact_start != std::string::npos && output().size() - _compact_start >= _compact_width)
+        expand_compact();
+}
+
+void buffer_pretty_encoder::expand_compact()
+{
+    std::string& out = output();
+    const bool        is_array        = out[_compact_start] == '[';
+    const bool        after_delimiter = _defer_indent && !_compact_entries.empty();
+    const std::size_t text_start      = _compact_start + 1;
+    const std::string text(out, text_start);
+    out.resize(text_start);
+    _compact_start = std::string::npos;
+
+    // Write everything after the opening bracket again, with each entry on its own line
+    for (std::size_t idx = 0; idx < _compact_entries.size(); ++idx)
+    {
+        bool        last        = idx + 1 == _compact_entries.size();
+        std::size_t entry_start = _compact_entries[idx] - text_start;
+        std::size_t entry_end   = last ? text.size() - (after_delimiter ? 2 : 0)
+                                       : _compact_entries[idx + 1] - text_start - 2;
+        write_eol();
+        out.append(text, entry_start, entry_end - entry_start);
+        if (!last || after_delimiter)
+            out.push_back(',');
+    }
+
+    // Pick up where a regular delimiter would have left off
+    if (after_delimiter && is_array)
+    {
+        write_eol();
+        _defer_indent = false;
+    }
+
+    defer_flush(false);
+    flush_if_full();
+}
+
+void buffer_pretty_encoder::write_array_begin()
+{
+    write_container_begin('[');
 }
 
-void ostream_pretty_encoder::write_array_delimiter()
+void buffer_pretty_encoder::write_array_end()
+{
+    write_container_end(']');
+}
+
+void buffer_pretty_encoder::write_array_delimiter()
+{
+    write_delimiter(true);
+}
+
+void buffer_pretty_encoder::write_boolean(bool value)
 {
     write_prefix();
-    ostream_encoder::write_array_delimiter();
-    write_eol();
+    buffer_encoder::write_boolean(value);
+    check_compact_width();
 }
 
-void ostream_pretty_encoder::write_boolean(bool value)
+void buffer_pretty_encoder::write_decimal(double value)
 {
     write_prefix();
-    ostream_encoder::write_boolean(value);
+    buffer_encoder::write_decimal(value);
+    check_compact_width();
 }
 
-void ostream_pretty_encoder::write_decimal(double value)
+void buffer_pretty_encoder::write_integer(int64_t value)
 {
     write_prefix();
-    ostream_encoder::write_decimal(value);
+    buffer_encoder::write_integer(value);
+    check_compact_width();
 }
 
-void ostream_pretty_encoder::write_integer(int64_t value)
+void buffer_pretty_encoder::write_null()
 {
     write_prefix();
-    ostream_encoder::write_integer(value);
+    buffer_encoder::write_null();
+    check_compact_width();
+}
+
+void buffer_pretty_encoder::write_object_begin()
+{
+    write_container_begin('{');
+}
+
+void buffer_pretty_encoder::write_object_end()
+{
+    write_container_end('}');
+}
+
+void buffer_pretty_encoder::write_object_delimiter()
+{
+    write_delimiter(false);
 }
 
-void ostream_pretty_encoder::write_null()
+void buffer_pretty_encoder::write_object_key(string_view key)
 {
     write_prefix();
-    ostream_encoder::write_null();
+    buffer_encoder::write_string(key);
+    output().append(": ", 2);
+    check_compact_width();
 }
 
-void ostream_pretty_encoder::write_object_begin()
+void buffer_pretty_encoder::write_string(string_view value)
 {
     write_prefix();
-    ostream_encoder::write_object_begin();
-    _indent += _indent_size;
-    _defer_indent = true;
+    buffer_encoder::write_string(value);
+    check_compact_width();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ostream_buffered_encoder                                                                                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ostream_buffered_encoder::ostream_buffered_encoder(std::ostream&   output,
+                                                   buffer_encoder& formatter,
+                                                   std::string     value_suffix
+                                                  ) :
+        ostream_encoder(output),
+        _formatter(formatter),
+        _value_suffix(std::move(value_suffix)),
+        _depth(0)
+{ }
+
+ostream_buffered_encoder::~ostream_buffered_encoder() noexcept = default;
+
+buffer_encoder::sink_type ostream_buffered_encoder::stream_sink(std::ostream& output)
+{
+    return [&output] (string_view chunk) { output.write(chunk.data(), std::streamsize(chunk.size())); };
 }
 
-void ostream_pretty_encoder::write_object_end()
+void ostream_buffered_encoder::flush_if_complete()
 {
-    _indent -= _indent_size;
-    if (!_defer_indent)
+    if (_depth == 0)
     {
-        write_eol();
+        _formatter.output().append(_value_suffix);
+        _formatter.flush();
     }
-    _defer_indent = false;
-    ostream_encoder::write_object_end();
 }
 
-void ostream_pretty_encoder::write_object_delimiter()
+void ostream_buffered_encoder::write_array_begin()
 {
-    ostream_encoder::write_object_delimiter();
-    _defer_indent = true;
+    ++_depth;
+    _formatter.write_array_begin();
 }
 
-void ostream_pretty_encoder::write_object_key(string_view key)
+void ostream_buffered_encoder::write_array_end()
 {
-    write_prefix();
-    ostream_encoder::write_object_key(key);
-    output() << ' ';
+    _formatter.write_array_end();
+    --_depth;
+    flush_if_complete();
 }
 
-void ostream_pretty_encoder::write_string(string_view value)
+void ostream_buffered_encoder::write_array_delimiter()
 {
-    write_prefix();
-    ostream_encoder::write_string(value);
+    _formatter.write_array_delimiter();
+}
+
+void ostream_buffered_encoder::write_boolean(bool value)
+{
+    _formatter.write_boolean(value);
+    flush_if_complete();
+}
+
+void ostream_buffered_encoder::write_decimal(double value)
+{
+    _formatter.write_decimal(value);
+    flush_if_complete();
 }
 
+void ostream_buffered_encoder::write_integer(int64_t value)
+{
+    _formatter.write_integer(value);
+    flush_if_complete();
+}
+
+void ostream_buffered_encoder::write_null()
+{
+    _formatter.write_null();
+    flush_if_complete();
+}
+
+void ostream_buffered_encoder::write_object_begin()
+{
+    ++_depth;
+    _formatter.write_object_begin();
+}
+
+void ostream_buffered_encoder::write_object_end()
+{
+    _formatter.write_object_end();
+    --_depth;
+    flush_if_complete();
+}
+
+void ostream_buffered_encoder::write_object_delimiter()
+{
+    _formatter.write_object_delimiter();
+}
+
+void ostream_buffered_encoder::write_object_key(string_view key)
+{
+    _formatter.ensure_ascii(ensure_ascii());
+    _formatter.write_object_key(key);
+}
+
+void ostream_buffered_encoder::write_string(string_view value)
+{
+    _formatter.ensure_ascii(ensure_ascii());
+    _formatter.write_string(value);
+    flush_if_complete();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ostream_pretty_encoder                                                                                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ostream_pretty_encoder::ostream_pretty_encoder(std::ostream& output, std::size_t indent_size) :
+        ostream_buffered_encoder(output, _pretty),
+        _pretty(stream_sink(output), indent_size)
+{ }
+
+ostream_pretty_encoder::~ostream_pretty_encoder() noexcept = default;
+
+void ostream_pretty_encoder::compact_width(std::size_t width)
+{
+    _pretty.compact_width(width);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// json_lines_encoder                                                                                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+json_lines_encoder::json_lines_encoder(std::ostream& output) :
+        ostream_buffered_encoder(output, _line, "\n"),
+        _line(stream_sink(output))
+{ }
+
+json_lines_encoder::~json_lines_encoder() noexcept = default;
+
 }
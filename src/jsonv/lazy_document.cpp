@@ -0,0 +1,451 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/lazy_document.hpp>
+#include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/number_decode.hpp>
+#include <jsonv/detail/simple_decode.hpp>
+
+#include "detail.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace jsonv
+{
+
+/** Find the line and column of the \a character in \a input, counting lines the same way \c parse does. **/
+static parse_error::problem locate_problem(string_view input, std::size_t character, std::string message)
+{
+    std::size_t line   = 1;
+    std::size_t column = 1;
+    for (const char c : input.substr(0, character))
+    {
+        if (c == '\n' || c == '\r')
+        {
+            ++line;
+            column = 1;
+        }
+        else
+        {
+            ++column;
+        }
+    }
+    return parse_error::problem(line, column, character, std::move(message));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_document::builder                                                                                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/** Checks the structure of the input and records the tape with a recursive descent over the tokens, mirroring the
+ *  checks made by \c parse.
+**/
+class lazy_document::builder
+{
+public:
+    explicit builder(lazy_document& document) :
+            _input(document._input),
+            _options(document._options),
+            _tape(document._tape),
+            _tokens(document._input),
+            _started(false)
+    { }
+
+    void build()
+    {
+        if (!next())
+            fail_at_end("No input");
+        build_value(1);
+
+        if (_options.require_document() && _tape[0].kind != kind::array && _tape[0].kind != kind::object)
+            fail_at(0, "JSON requires the root of a payload to be an array or object, not ", _tape[0].kind);
+
+        if (_options.complete_parse() && next())
+            fail("Found non-trivial data after final token. ", current().kind);
+    }
+
+private:
+    const tokenizer::token& current() const
+    {
+        return _tokens.current();
+    }
+
+    std::size_t offset() const
+    {
+        return std::size_t(current().text.data() - _input.data());
+    }
+
+    /** Move to the next token which is not whitespace or a comment. **/
+    bool next()
+    {
+        while (_tokens.next())
+        {
+            _started = true;
+            _last    = current().text;
+            if (current().kind == token_kind::comment)
+            {
+                if (!_options.comments())
+                    fail("JSON comment is not allowed");
+            }
+            else if (current().kind != token_kind::whitespace)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename... T>
+    [[noreturn]] void fail(T&&... message)
+    {
+        fail_at(offset(), std::forward<T>(message)..., ": \"", current().text, "\"");
+    }
+
+    /** Like \c fail, but for when the end of the input is reached. **/
+    template <typename... T>
+    [[noreturn]] void fail_at_end(T&&... message)
+    {
+        if (_started)
+            fail_at(_input.size(), std::forward<T>(message)..., ": \"", _last, "\"");
+        else
+            fail_at(_input.size(), std::forward<T>(message)...);
+    }
+
+    template <typename... T>
+    [[noreturn]] void fail_at(std::size_t character, T&&... message)
+    {
+        std::ostringstream stream;
+        using expand = int[];
+        (void) expand { 0, ((stream << std::forward<T>(message)), 0)... };
+        throw parse_error({ locate_problem(_input, character, stream.str()) }, null);
+    }
+
+    /** Record the value starting at the current token and everything in it. **/
+    void build_value(std::size_t depth)
+    {
+        std::size_t index = _tape.size();
+        _tape.push_back(tape_entry{ offset(), current().text.size(), 1, 0, kind::null });
+        switch (current().kind)
+        {
+        case token_kind::array_begin:
+            _tape[index].kind = kind::array;
+            check_depth(depth);
+            build_array(index, depth);
+            break;
+        case token_kind::object_begin:
+            _tape[index].kind = kind::object;
+            check_depth(depth);
+            build_object(index, depth);
+            break;
+        case token_kind::string:
+            _tape[index].kind = kind::string;
+            break;
+        case token_kind::number:
+            _tape[index].kind = kind::integer;
+            break;
+        case token_kind::boolean:
+            _tape[index].kind = kind::boolean;
+            break;
+        case token_kind::null:
+            _tape[index].kind = kind::null;
+            break;
+        default:
+            fail("Encountered invalid token ", current().kind);
+        }
+    }
+
+    void check_depth(std::size_t depth)
+    {
+        if (depth == _options.max_structure_depth())
+            fail("Structure depth reached maximum of ", depth);
+    }
+
+    /** Finish the entry at \a index for an array or object which ends at the current token. **/
+    void close(std::size_t index, std::size_t size)
+    {
+        _tape[index].length = offset() + current().text.size() - _tape[index].offset;
+        _tape[index].skip   = _tape.size() - index;
+        _tape[index].size   = size;
+    }
+
+    void build_array(std::size_t index, std::size_t depth)
+    {
+        std::size_t size = 0;
+        bool trailing_comma = false;
+        while (true)
+        {
+            if (!next())
+                fail_at_end("Unexpected end: unmatched '['");
+
+            if (current().kind == token_kind::array_end)
+            {
+                if (trailing_comma && _options.comma_policy() != parse_options::commas::allow_trailing)
+                    fail("Array contained a trailing comma");
+                break;
+            }
+
+            build_value(depth + 1);
+            ++size;
+
+            if (!next())
+                fail_at_end("Unexpected end: unmatched '['");
+
+            if (current().kind == token_kind::array_end)
+                break;
+            else if (current().kind == token_kind::separator)
+                trailing_comma = true;
+            else
+                fail("Invalid entry when looking for ',' or ']'");
+        }
+        close(index, size);
+    }
+
+    void build_object(std::size_t index, std::size_t depth)
+    {
+        std::size_t size = 0;
+        bool trailing_comma = false;
+        while (true)
+        {
+            if (!next())
+                fail_at_end("Unexpected end inside of object.");
+
+            if (current().kind == token_kind::object_end)
+            {
+                if (trailing_comma && _options.comma_policy() != parse_options::commas::allow_trailing)
+                    fail("Trailing comma at end of object.");
+                break;
+            }
+            else if (current().kind != token_kind::string)
+            {
+                fail("Expecting a key, but found ", current().kind);
+            }
+
+            _tape.push_back(tape_entry{ offset(), current().text.size(), 1, 0, kind::string });
+            // parse quotes the decoded key, but the encoded form is close enough for a message
+            string_view key = current().text.substr(1, current().text.size() - 2);
+
+            if (!next())
+                fail_at_end("Unexpected end: missing ':' for key '", key, "'");
+            if (current().kind != token_kind::object_key_delimiter)
+                fail("Invalid key-value delimiter...expecting ':' after key '", key, "'");
+            if (!next())
+                fail_at_end("Unexpected end: incomplete value for key '", key, "'");
+
+            build_value(depth + 1);
+            ++size;
+
+            if (!next())
+                fail_at_end("Unexpected end inside of object.");
+
+            if (current().kind == token_kind::object_end)
+                break;
+            else if (current().kind == token_kind::separator)
+                trailing_comma = true;
+            else
+                fail("Invalid token while searching for next value in object.");
+        }
+        close(index, size);
+    }
+
+private:
+    string_view                 _input;
+    const parse_options&        _options;
+    std::vector<tape_entry>&    _tape;
+    tokenizer                   _tokens;
+    bool                        _started;
+    string_view                 _last;      //!< The text of the last token, including whitespace and comments.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_document                                                                                                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+lazy_document::lazy_document(string_view input, const parse_options& options) :
+        _input(input),
+        _options(options)
+{
+    // most values take up at least a few characters
+    _tape.reserve(input.size() / 8 + 1);
+    builder(*this).build();
+    _tape.shrink_to_fit();
+}
+
+lazy_document::~lazy_document() noexcept = default;
+
+lazy_value lazy_document::root() const
+{
+    return lazy_value(this, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// lazy_value                                                                                                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+lazy_value::lazy_value(const lazy_document* document, std::size_t index) :
+        _document(document),
+        _index(index)
+{ }
+
+kind lazy_value::kind() const
+{
+    jsonv::kind recorded = _document->_tape[_index].kind;
+    if (recorded != jsonv::kind::integer)
+        return recorded;
+
+    std::int64_t integer;
+    double       decimal;
+    jsonv::kind decoded = detail::decode_number(text(), integer, decimal);
+    // the tokenizer allows some things which are not numbers, which is up to parse to complain about
+    return decoded == jsonv::kind::null ? to_value().kind() : decoded;
+}
+
+string_view lazy_value::text() const
+{
+    const lazy_document::tape_entry& entry = _document->_tape[_index];
+    return _document->_input.substr(entry.offset, entry.length);
+}
+
+lazy_value::size_type lazy_value::size() const
+{
+    check_type({ jsonv::kind::array, jsonv::kind::object }, _document->_tape[_index].kind);
+    return _document->_tape[_index].size;
+}
+
+lazy_value lazy_value::at(size_type idx) const
+{
+    check_type(jsonv::kind::array, _document->_tape[_index].kind);
+    const auto& tape = _document->_tape;
+    if (idx >= tape[_index].size)
+        throw std::out_of_range("Index " + std::to_string(idx) + " is out of range for an array of size "
+                                + std::to_string(tape[_index].size)
+                               );
+
+    std::size_t child = _index + 1;
+    for (; idx > 0; --idx)
+        child += tape[child].skip;
+    return lazy_value(_document, child);
+}
+
+std::vector<lazy_value> lazy_value::elements() const
+{
+    check_type(jsonv::kind::array, _document->_tape[_index].kind);
+    const auto& tape = _document->_tape;
+    std::vector<lazy_value> out;
+    out.reserve(tape[_index].size);
+    for (std::size_t child = _index + 1; out.size() < tape[_index].size; child += tape[child].skip)
+        out.push_back(lazy_value(_document, child));
+    return out;
+}
+
+lazy_value lazy_value::at(string_view key) const
+{
+    if (auto found = find(key))
+        return *found;
+    else
+        throw std::out_of_range("Key \"" + std::string(key) + "\" does not exist");
+}
+
+optional<lazy_value> lazy_value::find(string_view key) const
+{
+    check_type(jsonv::kind::object, _document->_tape[_index].kind);
+    const auto& tape = _document->_tape;
+    std::size_t child = _index + 1;
+    for (std::size_t remaining = tape[_index].size; remaining > 0; --remaining)
+    {
+        lazy_value encoded_key(_document, child);
+        string_view text = encoded_key.text();
+        text = text.substr(1, text.size() - 2);
+
+        // keys without escapes are compared as they are and the rest are decoded first
+        bool matched = text.find('\\') == string_view::npos ? text == key
+                                                            : encoded_key.to_value().as_string() == key;
+        if (matched)
+            return lazy_value(_document, child + 1);
+        child += 1 + tape[child + 1].skip;
+    }
+    return {};
+}
+
+std::vector<std::pair<std::string, lazy_value>> lazy_value::entries() const
+{
+    check_type(jsonv::kind::object, _document->_tape[_index].kind);
+    const auto& tape = _document->_tape;
+    std::vector<std::pair<std::string, lazy_value>> out;
+    out.reserve(tape[_index].size);
+    for (std::size_t child = _index + 1; out.size() < tape[_index].size; child += 1 + tape[child + 1].skip)
+    {
+        lazy_value encoded_key(_document, child);
+        string_view text = encoded_key.text();
+        text = text.substr(1, text.size() - 2);
+        out.emplace_back(text.find('\\') == string_view::npos ? std::string(text) : encoded_key.to_value().as_string(),
+                         lazy_value(_document, child + 1)
+                        );
+    }
+    return out;
+}
+
+lazy_value lazy_value::at_path(const path& p) const
+{
+    lazy_value current = *this;
+    for (const path_element& elem : p)
+    {
+        switch (elem.kind())
+        {
+        case path_element_kind::array_index:
+            check_type(jsonv::kind::array, current._document->_tape[current._index].kind);
+            if (elem.index() >= current.size())
+                throw std::out_of_range(to_string(elem) + " does not exist (full path: " + to_string(p) + ")");
+            current = current.at(elem.index());
+            break;
+        case path_element_kind::object_key:
+            if (auto found = current.find(elem.key()))
+                current = *found;
+            else
+                throw std::out_of_range(to_string(elem) + " does not exist (full path: " + to_string(p) + ")");
+            break;
+        default:
+            throw std::runtime_error(to_string(elem));
+        }
+    }
+    return current;
+}
+
+lazy_value lazy_value::at_path(string_view p) const
+{
+    return at_path(path::create(p));
+}
+
+value lazy_value::to_value() const
+{
+    value out;
+    if (detail::decode_simple(text(), _document->_tape[_index].kind, _document->_options, out))
+        return out;
+
+    // the structure was already checked when the document was created
+    parse_options options = _document->_options;
+    options.require_document(false)
+           .complete_parse(true)
+           .max_structure_depth(0);
+    try
+    {
+        return parse(text(), options);
+    }
+    catch (const parse_error& err)
+    {
+        std::size_t offset = _document->_tape[_index].offset;
+        parse_error::problem_list problems;
+        for (const parse_error::problem& problem : err.problems())
+            problems.push_back(locate_problem(_document->_input, offset + problem.character(), problem.message()));
+        throw parse_error(std::move(problems), err.partial_result());
+    }
+}
+
+}
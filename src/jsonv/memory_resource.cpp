@@ -0,0 +1,140 @@
+/** \file
+ *
+ *  Copyright (c) 2018 by Travis Gockel. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify it under the terms of the Apache License
+ *  as published by the Apache Software Foundation, either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  \author Travis Gockel (travis@gockelhut.com)
+**/
+#include <jsonv/memory_resource.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace jsonv
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// memory_resource                                                                                                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+memory_resource::~memory_resource() noexcept = default;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// new_delete_resource                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+class new_delete_memory_resource final :
+        public memory_resource
+{
+protected:
+    virtual void* do_allocate(std::size_t bytes, std::size_t) override
+    {
+        // operator new is aligned for anything up to max_align_t, which is all a value tree ever asks for
+        return ::operator new(bytes);
+    }
+
+    virtual void do_deallocate(void* p, std::size_t, std::size_t) override
+    {
+        ::operator delete(p);
+    }
+
+    virtual bool do_is_equal(const memory_resource& other) const noexcept override
+    {
+        return dynamic_cast<const new_delete_memory_resource*>(&other) != nullptr;
+    }
+};
+
+}
+
+memory_resource* new_delete_resource() noexcept
+{
+    static new_delete_memory_resource instance;
+    return &instance;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// monotonic_buffer_resource                                                                                          //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct monotonic_buffer_resource::block
+{
+    block*      next;
+    std::size_t size;
+};
+
+monotonic_buffer_resource::monotonic_buffer_resource(std::size_t initial_size, memory_resource* upstream) :
+        _upstream(upstream),
+        _next_size(std::max(initial_size, sizeof(block) * 2)),
+        _blocks(nullptr),
+        _current(nullptr),
+        _end(nullptr)
+{ }
+
+monotonic_buffer_resource::~monotonic_buffer_resource() noexcept
+{
+    release();
+}
+
+void monotonic_buffer_resource::release() noexcept
+{
+    while (_blocks)
+    {
+        block* next = _blocks->next;
+        _upstream->deallocate(_blocks, _blocks->size);
+        _blocks = next;
+    }
+    _current = nullptr;
+    _end     = nullptr;
+}
+
+std::size_t monotonic_buffer_resource::upstream_bytes() const noexcept
+{
+    std::size_t total = 0;
+    for (const block* iter = _blocks; iter; iter = iter->next)
+        total += iter->size;
+    return total;
+}
+
+static char* align_up(char* p, std::size_t alignment)
+{
+    auto address = reinterpret_cast<std::uintptr_t>(p);
+    return p + ((alignment - address % alignment) % alignment);
+}
+
+void* monotonic_buffer_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    char* start = _current ? align_up(_current, alignment) : nullptr;
+    if (!start || std::size_t(_end - start) < bytes)
+    {
+        std::size_t size = std::max(_next_size, sizeof(block) + bytes + alignment);
+        auto next = static_cast<block*>(_upstream->allocate(size));
+        next->next = _blocks;
+        next->size = size;
+        _blocks    = next;
+        _next_size = size * 2;
+        _end       = reinterpret_cast<char*>(next) + size;
+        start      = align_up(reinterpret_cast<char*>(next + 1), alignment);
+    }
+
+    _current = start + bytes;
+    return start;
+}
+
+void monotonic_buffer_resource::do_deallocate(void*, std::size_t, std::size_t)
+{
+    // memory is only given back on release
+}
+
+bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+}
@@ -68,9 +68,14 @@ object_node_handle::mapped_type& object_node_handle::mapped() const
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 value object()
+{
+    return detail::make_object(new_delete_resource());
+}
+
+value detail::make_object(memory_resource* resource)
 {
     value x;
-    x._data.object = new detail::object_impl;
+    x._data.object = create_in<object_impl>(resource, resource);
     x._kind = jsonv::kind::object;
     return x;
 }
@@ -225,7 +230,7 @@ value::object_iterator value::insert(value::const_object_iterator hint, std::pai
 std::pair<value::object_iterator, bool> value::insert(std::pair<std::string, value> pair)
 {
     check_type(jsonv::kind::object, kind());
-    auto ret = _data.object->_values.insert(pair);
+    auto ret = _data.object->_values.insert(std::move(pair));
     return { object_iterator(ret.first), ret.second };
 }
 
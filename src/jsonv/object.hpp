@@ -15,7 +15,11 @@
 #include <jsonv/value.hpp>
 #include <jsonv/detail.hpp>
 
-#include <map>
+#if JSONV_OBJECT_USE_FLAT_MAP
+#   include <jsonv/detail/flat_map.hpp>
+#else
+#   include <map>
+#endif
 
 namespace jsonv
 {
@@ -26,11 +30,33 @@ class JSONV_LOCAL object_impl :
         public cloneable<object_impl>
 {
 public:
-    using map_type       = std::map<std::string, jsonv::value>;
+#if JSONV_OBJECT_USE_FLAT_MAP
+    using map_type       = flat_map<std::string,
+                                    jsonv::value,
+                                    resource_allocator<std::pair<const std::string, jsonv::value>>
+                                   >;
+#else
+    using map_type       = std::map<std::string,
+                                    jsonv::value,
+                                    std::less<std::string>,
+                                    resource_allocator<std::pair<const std::string, jsonv::value>>
+                                   >;
+#endif
     using iterator       = map_type::iterator;
     using const_iterator = map_type::const_iterator;
     
 public:
+    explicit object_impl(memory_resource* resource = new_delete_resource()) :
+            _values(map_type::allocator_type(resource))
+    { }
+    
+    object_impl(const object_impl&) = default;
+    
+    memory_resource* resource() const
+    {
+        return _values.get_allocator().resource();
+    }
+    
     bool empty() const;
     
     value::size_type size() const;
@@ -13,16 +13,29 @@
 #include <jsonv/encode.hpp>
 #include <jsonv/object.hpp>
 #include <jsonv/tokenizer.hpp>
+#include <jsonv/detail/mapped_file.hpp>
+#include <jsonv/detail/number_decode.hpp>
+#include <jsonv/detail/parallel.hpp>
+#include <jsonv/detail/scope_exit.hpp>
+#include <jsonv/detail/simd_scan.hpp>
+#include <jsonv/detail/token_patterns.hpp>
 
 #include "char_convert.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <istream>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <streambuf>
+#include <unordered_map>
 #include <vector>
 
 #if 0
@@ -237,6 +250,39 @@ parse_options& parse_options::comments(bool val)
     return *this;
 }
 
+bool parse_options::intern_strings() const
+{
+    return _intern_strings;
+}
+
+parse_options& parse_options::intern_strings(bool val)
+{
+    _intern_strings = val;
+    return *this;
+}
+
+memory_resource* parse_options::resource() const
+{
+    return _resource;
+}
+
+parse_options& parse_options::resource(memory_resource* val)
+{
+    _resource = val ? val : new_delete_resource();
+    return *this;
+}
+
+bool parse_options::borrow_input() const
+{
+    return _borrow_input;
+}
+
+parse_options& parse_options::borrow_input(bool val)
+{
+    _borrow_input = val;
+    return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // parsing internals                                                                                                  //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -244,11 +290,115 @@ parse_options& parse_options::comments(bool val)
 namespace detail
 {
 
-struct JSONV_LOCAL parse_context
+/** FNV-1a, which is plenty for the short strings it is used on while parsing. **/
+static std::size_t hash_text(string_view text)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : text)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return std::size_t(hash);
+}
+
+/** An entry of an object which has been parsed, but not added to it yet. Objects are built by collecting all of their
+ *  entries, then sorting them and adding them in order, which appends to the map instead of doing a sorted insert for
+ *  every key.
+**/
+struct JSONV_LOCAL pending_entry
+{
+    std::string key;
+    value       val;
+    bool        replaced; //!< A later entry of the object has the same key.
+};
+
+/** Finds the earlier entry of an object with the same key as each new one, so a duplicate key is reported as soon as it
+ *  is parsed even though the object is only built once it ends. This is an open-addressing hash table of positions in a
+ *  \c std::vector of \c pending_entry, which is reused from one object to the next without clearing or allocating.
+**/
+class JSONV_LOCAL key_finder
+{
+public:
+    static constexpr std::size_t npos = std::size_t(-1);
+    
+public:
+    /** Forget the keys of the last object. **/
+    void reset()
+    {
+        ++_generation;
+        _count = 0;
+    }
+    
+    /** Add the key of the entry at \a idx of \a entries. If an earlier entry had the same key, the new one takes its
+     *  place.
+     *  
+     *  \returns The position of the earlier entry with the same key or \c npos if there is none.
+    **/
+    std::size_t add(const std::vector<pending_entry>& entries, std::size_t idx)
+    {
+        if ((_count + 1) * 2 > _slots.size())
+            grow();
+        
+        const std::size_t hash = hash_text(entries[idx].key);
+        const std::size_t mask = _slots.size() - 1;
+        for (std::size_t pos = hash & mask; ; pos = (pos + 1) & mask)
+        {
+            slot& current = _slots[pos];
+            if (current.generation != _generation)
+            {
+                current = { hash, idx, _generation };
+                ++_count;
+                return npos;
+            }
+            else if (current.hash == hash && entries[current.index].key == entries[idx].key)
+            {
+                std::size_t earlier = current.index;
+                current.index = idx;
+                return earlier;
+            }
+        }
+    }
+    
+private:
+    struct slot
+    {
+        std::size_t hash;
+        std::size_t index;
+        std::size_t generation; //!< The slot is only in use if this is the current \c _generation.
+    };
+    
+    void grow()
+    {
+        std::vector<slot> old(std::max<std::size_t>(16, _slots.size() * 2), slot{ 0, 0, 0 });
+        old.swap(_slots);
+        
+        const std::size_t mask = _slots.size() - 1;
+        for (const slot& entry : old)
+        {
+            if (entry.generation != _generation)
+                continue;
+            
+            std::size_t pos = entry.hash & mask;
+            while (_slots[pos].generation == _generation)
+                pos = (pos + 1) & mask;
+            _slots[pos] = entry;
+        }
+    }
+    
+private:
+    std::vector<slot> _slots;
+    std::size_t       _count      = 0;
+    std::size_t       _generation = 1;
+};
+
+/** Tracks the location in the input and the problems encountered while parsing. This is shared between the various
+ *  parsing strategies.
+**/
+struct JSONV_LOCAL parse_reporter
 {
     using size_type = std::size_t;
     
-    tokenizer&       input;
     parse_options    options;
     string_decode_fn string_decode;
     
@@ -258,98 +408,71 @@ struct JSONV_LOCAL parse_context
     
     bool                             successful;
     jsonv::parse_error::problem_list problems;
-    bool                             complete;
     
-    explicit parse_context(const parse_options& options, tokenizer& input) :
-            input(input),
+    /** The token to quote in error messages (if there is one). **/
+    const tokenizer::token*          error_token;
+    
+    explicit parse_reporter(const parse_options& options) :
             options(options),
             string_decode(get_string_decoder(options.string_encoding())),
-            line(0),
+            line(1),
             column(1),
             character(0),
             successful(true),
             problems(),
-            complete(false)
+            error_token(nullptr)
     { }
     
-    parse_context(const parse_context&) = delete;
-    parse_context& operator=(const parse_context&) = delete;
+    parse_reporter(const parse_reporter&) = delete;
+    parse_reporter& operator=(const parse_reporter&) = delete;
     
-    bool next()
+    /** Move the location past the given \a text. **/
+    void advance(string_view text)
     {
-        if (!complete && line != 0)
-        {
-            character += current().text.size();
-            for (const char c : current().text)
-            {
-                if (c == '\n' || c == '\r')
-                {
-                    ++line;
-                    column = 1;
-                }
-                else
-                {
-                    ++column;
-                }
-            }
-        }
-        else
+        character += text.size();
+        for (const char c : text)
         {
-            ++line;
-        }
-        
-        if (input.next())
-        {
-            JSONV_DBG_NEXT("(" << input.current().text << " cxt:" << input.current().kind << ")");
-            if (current_kind() == token_kind::whitespace)
-            {
-                return next();
-            }
-            else if (current_kind() == token_kind::comment)
+            if (c == '\n' || c == '\r')
             {
-                if (!options.comments())
-                    parse_error("JSON comment is not allowed");
-                return next();
+                ++line;
+                column = 1;
             }
             else
             {
-                return true;
+                ++column;
             }
         }
-        else
-        {
-            complete = true;
-            return false;
-        }
     }
     
-    const tokenizer::token& current() const
+    template <typename... T>
+    void parse_error(T&&... message)
     {
-        return input.current();
+        std::ostringstream stream;
+        parse_error_impl(stream, std::forward<T>(message)...);
     }
     
-    const token_kind& current_kind() const
+    /** Report that \a key appears more than once in an object, where \a old_value is being replaced by
+     *  \a new_value.
+    **/
+    void duplicate_key(const std::string& key, const value& old_value, const value& new_value)
     {
-        return current().kind;
+        parse_error("Duplicate entries for key '", key, "'. ",
+                    "Updating old value ", old_value, " with new value ", new_value, "."
+                   );
     }
     
-    template <typename... T>
-    void parse_error(T&&... message)
+    /** Throw the problems encountered so far (if any) unless the \c parse_options say to ignore them. **/
+    void throw_if_failed(value partial_result) const
     {
-        std::ostringstream stream;
-        parse_error_impl(stream, std::forward<T>(message)...);
+        if (!successful && options.failure_mode() != parse_options::on_error::ignore)
+            throw jsonv::parse_error(problems, std::move(partial_result));
     }
     
 private:
     void parse_error_impl(std::ostringstream& stream)
     {
-        try
-        {
-            string_view text = current().text;
-            stream << ": \"" << text << "\"";
-        }
-        catch (const std::logic_error&)
-        { }
+        if (error_token)
+            stream << ": \"" << error_token->text << "\"";
         jsonv::parse_error::problem problem(line, column, character, stream.str());
         if (options.failure_mode() == parse_options::on_error::fail_immediately)
         {
@@ -371,17 +494,176 @@ private:
     }
 };
 
+/** Add the \a entries parsed for an object from \a first on to \a out and remove them from \a entries. Entries which
+ *  were \c replaced by a later one with the same key are left out.
+**/
+static void add_entries(std::vector<pending_entry>& entries, std::size_t first, value& out)
+{
+    const auto begin = entries.begin() + first;
+    std::sort(begin, entries.end(), [] (const pending_entry& a, const pending_entry& b) { return a.key < b.key; });
+    for (auto iter = begin; iter != entries.end(); ++iter)
+        if (!iter->replaced)
+            out.insert(out.end_object(), { std::move(iter->key), std::move(iter->val) });
+    entries.erase(begin, entries.end());
+}
+
+/** Remembers decoded strings by their encoded text, so a string which appears many times in a document is only decoded
+ *  once and every \c value made from it shares the same storage.
+ *  
+ *  At most \c max_entries strings are remembered. When it is full, everything is forgotten and remembering starts over.
+ *  This keeps the memory bounded for a \c json_lines_reader, which uses one interner for every line of a stream of any
+ *  length, while strings repeated from one line to the next are still shared.
+**/
+class JSONV_LOCAL string_interner
+{
+public:
+    /** The longest encoded text which will be remembered. Longer strings are rarely repeated. **/
+    static constexpr std::size_t max_length = 64;
+    
+    /** The most strings which are remembered at once. **/
+    static constexpr std::size_t max_entries = 16 * 1024;
+    
+    /** Find the string previously interned for the encoded \a text.
+     *  
+     *  \returns The interned \c value or \c nullptr if \a text has not been seen.
+    **/
+    const value* find(string_view text) const
+    {
+        auto iter = _values.find(text);
+        return iter == _values.end() ? nullptr : &iter->second;
+    }
+    
+    const value& insert(string_view text, value decoded)
+    {
+        if (_values.size() == max_entries)
+        {
+            _values.clear();
+            _text.clear();
+        }
+        _text.emplace_back(text.data(), text.size());
+        return _values.emplace(string_view(_text.back()), std::move(decoded)).first->second;
+    }
+    
+private:
+    struct text_hash
+    {
+        std::size_t operator()(string_view text) const
+        {
+            return hash_text(text);
+        }
+    };
+    
+private:
+    // _values refers to the strings in _text, which a std::deque never moves
+    std::deque<std::string>                         _text;
+    std::unordered_map<string_view, value, text_hash> _values;
+};
+
+struct JSONV_LOCAL parse_context :
+        public parse_reporter
+{
+    tokenizer*      input;
+    bool            complete;
+    bool            started;
+    bool            borrow;   //!< Can strings refer to the text of \c input? See \c parse_options::borrow_input.
+    string_interner interner;
+    
+    /** The entries of every object being parsed. Each nested object adds its entries after those of the objects
+     *  containing it and takes them off again when it finishes, before the entry it is the value of is added.
+    **/
+    std::vector<pending_entry> entries;
+    
+    /** The \c key_finder for each object being parsed, by depth. Deeper ones are kept around for the next time. **/
+    std::vector<key_finder>    key_finders;
+    std::size_t                open_objects;
+    
+    explicit parse_context(const parse_options& options, tokenizer& input, bool stable_input = false) :
+            parse_reporter(options),
+            input(&input),
+            complete(false),
+            started(false),
+            borrow(stable_input && options.borrow_input()),
+            open_objects(0)
+    { }
+    
+    /** Start over on \a next_input, which begins at \a line_ of the whole input and \a character_ characters into it.
+     *  Problems found so far are forgotten, but interned strings are kept (up to \c string_interner::max_entries of
+     *  them), so strings repeated from one input to the next are shared.
+    **/
+    void restart(tokenizer& next_input, size_type line_, size_type character_)
+    {
+        input       = &next_input;
+        complete    = false;
+        started     = false;
+        line        = line_;
+        column      = 1;
+        character   = character_;
+        successful  = true;
+        error_token = nullptr;
+        problems.clear();
+        entries.clear();
+        open_objects = 0;
+    }
+    
+    bool next()
+    {
+        if (!complete && started)
+            advance(current().text);
+        
+        if (input->next())
+        {
+            started     = true;
+            error_token = &input->current();
+            JSONV_DBG_NEXT("(" << input->current().text << " cxt:" << input->current().kind << ")");
+            if (current_kind() == token_kind::whitespace)
+            {
+                return next();
+            }
+            else if (current_kind() == token_kind::comment)
+            {
+                if (!options.comments())
+                    parse_error("JSON comment is not allowed");
+                return next();
+            }
+            else
+            {
+                return true;
+            }
+        }
+        else
+        {
+            complete = true;
+            return false;
+        }
+    }
+    
+    const tokenizer::token& current() const
+    {
+        return input->current();
+    }
+    
+    const token_kind& current_kind() const
+    {
+        return current().kind;
+    }
+};
+
 static bool parse_generic(parse_context& context, value& out, bool advance = true);
 
-static void check_token(parse_context& context, string_view expected_token)
+static void check_token(parse_reporter& reporter, string_view text, string_view expected_token)
 {
-    if (context.current().text != expected_token)
-        context.parse_error("Failed to match \"", expected_token, "\""
-            , "\t", context.current().text.length(), " ", expected_token.length(), "\t",
-            std::equal(expected_token.begin(), expected_token.end(), context.current().text.begin())
+    if (text != expected_token)
+        reporter.parse_error("Failed to match \"", expected_token, "\""
+            , "\t", text.length(), " ", expected_token.length(), "\t",
+            std::equal(expected_token.begin(), expected_token.end(), text.begin())
         );
 }
 
+static void check_token(parse_context& context, string_view expected_token)
+{
+    check_token(context, context.current().text, expected_token);
+}
+
 static bool parse_boolean(parse_context& context, value& out)
 {
     assert(context.current_kind() == token_kind::boolean);
@@ -409,11 +691,8 @@ static bool parse_null(parse_context& context, value& out)
     return true;
 }
 
-static bool parse_number(parse_context& context, value& out)
+static void check_number_encoding(parse_reporter& context, string_view characters)
 {
-    JSONV_DBG_STRUCT("#");
-    string_view characters = context.current().text;
-
     if (  context.options.number_encoding() == parse_options::numbers::strict
        && characters.size() > 1U
        && characters.at(0) == '0'
@@ -421,91 +700,112 @@ static bool parse_number(parse_context& context, value& out)
     {
         context.parse_error("Numbers cannot start with a leading '0'");
     }
+}
 
-    auto end = const_cast<char*>(characters.data() + characters.length());
-
-    // optimization: a numeric token is "decimal-like" if it has . in it
-    if (characters.find_first_of(".Ee") != string_view::npos)
-    {
-        auto scan_end = end;
-        auto val = std::strtod(characters.data(), &scan_end);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
-    else if (characters[0] == '-')
-    {
-        auto scan_end = end;
-        auto val      = std::strtoul(characters.data(), &scan_end, 10);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
-    else
-    {
-        // For non-negative integer types, use lexical_cast of a uint64_t then static_cast to an int64_t. This is done
-        // to deal with the values 2^63..2^64-1 -- do not consider it an exception, as we can store the bits properly,
-        // but the onus is on the user to know the particular key was in the overflow range.
-        auto scan_end = end;
-        auto val      = std::strtoull(characters.data(), &scan_end, 10);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
-    }
+static bool parse_number(parse_context& context, value& out)
+{
+    JSONV_DBG_STRUCT("#");
+    string_view characters = context.current().text;
+    check_number_encoding(context, characters);
 
-    // Numbers that do not contain decimals or exponents, but are too large might still be representable as a double
+    std::int64_t integer;
+    double       decimal;
+    switch (decode_number(characters, integer, decimal))
     {
-        auto scan_end = end;
-        auto val = std::strtod(characters.data(), &scan_end);
-        if (end == scan_end)
-        {
-            out = val;
-            return true;
-        }
+    case kind::integer:
+        out = integer;
+        return true;
+    case kind::decimal:
+        out = decimal;
+        return true;
+    default:
+        context.parse_error("Could not extract number from \"", characters, "\"");
+        return true;
     }
-
-    context.parse_error("Could not extract number from \"", characters, "\"");
-    return true;
 }
 
-static std::string parse_string(parse_context& context)
+/** Decode the \a text of a \c token_kind::string (including the surrounding quotes). **/
+static std::string decode_string(parse_reporter& reporter, string_view text)
 {
-    assert(context.current_kind() == token_kind::string);
-    
-    string_view source = context.current().text;
-    JSONV_DBG_STRUCT(source);
+    JSONV_DBG_STRUCT(text);
     // chop off the ""s
-    source.remove_prefix(1);
-    source.remove_suffix(1);
+    text.remove_prefix(1);
+    text.remove_suffix(1);
     
     try
     {
-        return context.string_decode(source);
+        return reporter.string_decode(text);
     }
     catch (const detail::decode_error& err)
     {
-        context.parse_error("Error decoding string:", err.what());
+        reporter.parse_error("Error decoding string:", err.what());
         // return it un-decoded
-        return std::string(source);
+        return std::string(text);
     }
 }
 
+static std::string parse_string(parse_context& context)
+{
+    assert(context.current_kind() == token_kind::string);
+    return decode_string(context, context.current().text);
+}
+
+/** Should the current token be looked up in or added to the \c string_interner? Once there has been an error, nothing
+ *  more is interned, so a string which failed to decode is not remembered and later occurrences are reported, too.
+**/
+static bool should_intern(const parse_context& context)
+{
+    return context.options.intern_strings()
+        && context.successful
+        && context.current().text.size() <= string_interner::max_length;
+}
+
 static bool parse_string(parse_context& context, value& out)
 {
-    out = parse_string(context);
+    if (!should_intern(context))
+    {
+        string_view text = context.current().text;
+        if (context.borrow && needs_no_decoding(text))
+            out = detail::borrow_string(text.substr(1, text.size() - 2), context.options.resource());
+        else
+            out = detail::make_string(parse_string(context), context.options.resource());
+    }
+    else if (const value* interned = context.interner.find(context.current().text))
+    {
+        out = *interned;
+    }
+    else
+    {
+        out = parse_string(context);
+        if (should_intern(context))
+            context.interner.insert(context.current().text, out);
+    }
     return true;
 }
 
+static std::string parse_key(parse_context& context)
+{
+    if (!should_intern(context))
+    {
+        return parse_string(context);
+    }
+    else if (const value* interned = context.interner.find(context.current().text))
+    {
+        return interned->as_string();
+    }
+    else
+    {
+        std::string key = parse_string(context);
+        if (should_intern(context))
+            context.interner.insert(context.current().text, key);
+        return key;
+    }
+}
+
 static bool parse_array(parse_context& context, value& arr)
 {
     JSONV_DBG_STRUCT('[');
-    arr = array();
+    arr = detail::make_array(context.options.resource());
     bool trailing_comma = false;
     
     while (true)
@@ -557,9 +857,12 @@ static bool parse_array(parse_context& context, value& arr)
     return false;
 }
 
-static bool parse_object(parse_context& context, value& out)
+/** Parse the entries of an object up to and including the closing \c '}', adding them to \c parse_context::entries.
+ *  
+ *  \returns \c false if the input ended before the object did.
+**/
+static bool parse_object_entries(parse_context& context, std::size_t depth)
 {
-    out = object();
     bool trailing_comma = false;
     
     while (context.next())
@@ -567,7 +870,7 @@ static bool parse_object(parse_context& context, value& out)
         std::string key;
         if (context.current_kind() == token_kind::string)
         {
-            key = parse_string(context);
+            key = parse_key(context);
             trailing_comma = false;
         }
         else if (context.current_kind() == token_kind::object_end)
@@ -599,17 +902,12 @@ static bool parse_object(parse_context& context, value& out)
             return false;
         }
         
-        auto iter = out.find(key);
-        if (iter == out.end_object())
-        {
-            out.insert({ std::move(key), std::move(val) });
-        }
-        else
+        context.entries.push_back({ std::move(key), std::move(val), false });
+        std::size_t earlier = context.key_finders[depth].add(context.entries, context.entries.size() - 1);
+        if (earlier != key_finder::npos)
         {
-            context.parse_error("Duplicate entries for key '", key, "'. ",
-                                "Updating old value ", iter->second, " with new value ", val, "."
-                               );
-            iter->second = std::move(val);
+            context.entries[earlier].replaced = true;
+            context.duplicate_key(context.entries.back().key, context.entries[earlier].val, context.entries.back().val);
         }
         
         if (!context.next())
@@ -627,6 +925,21 @@ static bool parse_object(parse_context& context, value& out)
     return false;
 }
 
+static bool parse_object(parse_context& context, value& out)
+{
+    out = detail::make_object(context.options.resource());
+    const std::size_t first_entry = context.entries.size();
+    const std::size_t depth       = context.open_objects++;
+    auto close_object = on_scope_exit([&context] { --context.open_objects; });
+    if (context.key_finders.size() == depth)
+        context.key_finders.emplace_back();
+    context.key_finders[depth].reset();
+    
+    bool complete = parse_object_entries(context, depth);
+    add_entries(context.entries, first_entry, out);
+    return complete;
+}
+
 /** This function skips over anything that isn't one of the "separator" characters. It is intended to make parse errors
  *  a little more reasonable.
 **/
@@ -733,8 +1046,542 @@ private:
     parse_options::size_type _current_depth;
 };
 
-}
-
+/** Drives an \c encoder directly from a sequence of tokens. This performs the same validation as \c parse_generic, but
+ *  the structure is tracked with an explicit stack of states instead of recursion, so tokens can be pushed one at a
+ *  time as they become available.
+**/
+class JSONV_LOCAL event_parser :
+        public parse_reporter
+{
+public:
+    explicit event_parser(const parse_options& options, encoder& handler) :
+            parse_reporter(options),
+            _handler(handler),
+            _states({ state::document_begin })
+    { }
+    
+    /** Process the next \a token of input, including whitespace and comments. **/
+    void push(const tokenizer::token& token)
+    {
+        error_token = &token;
+        switch (token.kind)
+        {
+        case token_kind::whitespace:
+            break;
+        case token_kind::comment:
+            if (!options.comments())
+                parse_error("JSON comment is not allowed");
+            break;
+        default:
+            push_structural(token);
+            break;
+        }
+        advance(token.text);
+        error_token = nullptr;
+    }
+    
+    /** Has a complete root value been seen? **/
+    bool value_complete() const
+    {
+        return _states.back() == state::document_end;
+    }
+    
+    /** Signal the end of input. This closes any unterminated structures. **/
+    void finish()
+    {
+        if (_states.back() == state::document_begin)
+            parse_error("No input");
+        
+        while (_states.size() > 1U)
+        {
+            switch (_states.back())
+            {
+            case state::array_first:
+            case state::array_value:
+            case state::array_after_value:
+                parse_error("Unexpected end: unmatched '['");
+                break;
+            case state::object_delimiter:
+            case state::object_value:
+                parse_error("Unexpected end: incomplete value for key '", _key, "'");
+                _handler.write_null();
+                break;
+            default:
+                parse_error("Unexpected end inside of object.");
+                break;
+            }
+            close();
+        }
+    }
+    
+private:
+    enum class state : unsigned char
+    {
+        document_begin,
+        document_end,
+        array_first,
+        array_value,
+        array_after_value,
+        object_first,
+        object_key,
+        object_delimiter,
+        object_value,
+        object_after_value,
+    };
+    
+    static bool starts_value(token_kind kind)
+    {
+        switch (kind)
+        {
+        case token_kind::array_begin:
+        case token_kind::object_begin:
+        case token_kind::boolean:
+        case token_kind::null:
+        case token_kind::number:
+        case token_kind::string:
+            return true;
+        default:
+            return false;
+        }
+    }
+    
+    void push_structural(const tokenizer::token& token)
+    {
+        state& current = _states.back();
+        switch (current)
+        {
+        case state::document_begin:
+            if (  options.require_document()
+               && token.kind != token_kind::array_begin
+               && token.kind != token_kind::object_begin
+               )
+            {
+                parse_error("JSON requires the root of a payload to be an array or object, not ", token.kind);
+            }
+            push_value(token);
+            break;
+        case state::document_end:
+            if (token.kind != token_kind::unknown)
+            {
+                // At the end of input, we might have a few nulls -- this is expected for string literals, so ignore
+                // them.
+                if (std::any_of(token.text.begin(), token.text.end(), [] (char c) { return c != '\0'; }))
+                    parse_error("Found non-trivial data after final token. ", token.kind);
+            }
+            break;
+        case state::array_first:
+        case state::array_value:
+            if (token.kind == token_kind::array_end)
+            {
+                if (  current == state::array_value
+                   && options.comma_policy() != parse_options::commas::allow_trailing
+                   )
+                {
+                    parse_error("Array contained a trailing comma");
+                }
+                close();
+            }
+            else if (starts_value(token.kind))
+            {
+                if (current == state::array_value)
+                    _handler.write_array_delimiter();
+                push_value(token);
+            }
+            else
+            {
+                parse_error("Encountered invalid token ", token.kind, ": \"", token.text, "\"");
+            }
+            break;
+        case state::array_after_value:
+            if (token.kind == token_kind::array_end)
+                close();
+            else if (token.kind == token_kind::separator)
+                current = state::array_value;
+            else
+                parse_error("Invalid entry when looking for ',' or ']'");
+            break;
+        case state::object_first:
+        case state::object_key:
+            if (token.kind == token_kind::object_end)
+            {
+                if (  current == state::object_key
+                   && options.comma_policy() != parse_options::commas::allow_trailing
+                   )
+                {
+                    parse_error("Trailing comma at end of object.");
+                }
+                close();
+                break;
+            }
+            else if (token.kind == token_kind::string)
+            {
+                _key = decode_string(*this, token.text);
+            }
+            else
+            {
+                parse_error("Expecting a key, but found ", token.kind);
+                // simulate a new key
+                _key.assign(token.text.data(), token.text.size());
+            }
+            
+            if (current == state::object_key)
+                _handler.write_object_delimiter();
+            _handler.write_object_key(_key);
+            current = state::object_delimiter;
+            break;
+        case state::object_delimiter:
+            if (token.kind != token_kind::object_key_delimiter)
+                parse_error("Invalid key-value delimiter...expecting ':' after key '", _key, "'");
+            current = state::object_value;
+            break;
+        case state::object_value:
+            if (starts_value(token.kind))
+                push_value(token);
+            else
+                parse_error("Encountered invalid token ", token.kind, ": \"", token.text, "\"");
+            break;
+        case state::object_after_value:
+            if (token.kind == token_kind::object_end)
+                close();
+            else if (token.kind == token_kind::separator)
+                current = state::object_key;
+            else
+                parse_error("Invalid token while searching for next value in object.");
+            break;
+        }
+    }
+    
+    /** Move the current state past a value which is about to be written. **/
+    void begin_value()
+    {
+        state& current = _states.back();
+        switch (current)
+        {
+        case state::document_begin:
+            current = state::document_end;
+            break;
+        case state::array_first:
+        case state::array_value:
+            current = state::array_after_value;
+            break;
+        case state::object_value:
+            current = state::object_after_value;
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
+    
+    void push_value(const tokenizer::token& token)
+    {
+        switch (token.kind)
+        {
+        case token_kind::array_begin:
+            begin_value();
+            _handler.write_array_begin();
+            open(state::array_first);
+            break;
+        case token_kind::object_begin:
+            begin_value();
+            _handler.write_object_begin();
+            open(state::object_first);
+            break;
+        case token_kind::boolean:
+            begin_value();
+            check_token(*this, token.text, token.text.at(0) == 't' ? "true" : "false");
+            _handler.write_boolean(token.text.at(0) == 't');
+            break;
+        case token_kind::null:
+            begin_value();
+            check_token(*this, token.text, "null");
+            _handler.write_null();
+            break;
+        case token_kind::number:
+        {
+            begin_value();
+            check_number_encoding(*this, token.text);
+            std::int64_t integer;
+            double       decimal;
+            switch (decode_number(token.text, integer, decimal))
+            {
+            case kind::integer:
+                _handler.write_integer(integer);
+                break;
+            case kind::decimal:
+                _handler.write_decimal(decimal);
+                break;
+            default:
+                parse_error("Could not extract number from \"", token.text, "\"");
+                _handler.write_null();
+                break;
+            }
+            break;
+        }
+        case token_kind::string:
+            begin_value();
+            _handler.write_string(decode_string(*this, token.text));
+            break;
+        default:
+            parse_error("Encountered invalid token ", token.kind, ": \"", token.text, "\"");
+            break;
+        }
+    }
+    
+    void open(state initial)
+    {
+        _states.push_back(initial);
+        if (options.max_structure_depth() > 0 && _states.size() - 1U == options.max_structure_depth())
+            parse_error("Structure depth reached maximum of ", _states.size() - 1U);
+    }
+    
+    void close()
+    {
+        switch (_states.back())
+        {
+        case state::array_first:
+        case state::array_value:
+        case state::array_after_value:
+            _states.pop_back();
+            _handler.write_array_end();
+            break;
+        default:
+            _states.pop_back();
+            _handler.write_object_end();
+            break;
+        }
+    }
+    
+private:
+    encoder&           _handler;
+    std::vector<state> _states;
+    std::string        _key;
+};
+
+/** An \c encoder which builds a \c value from the calls made to it. Like \c parse_object, the entries of an object are
+ *  collected until it ends and duplicate keys are reported to the \c parse_reporter given to \c report_to.
+**/
+class JSONV_LOCAL value_builder :
+        public encoder
+{
+public:
+    value_builder() :
+            _reporter(nullptr),
+            _resource(new_delete_resource()),
+            _open_objects(0)
+    { }
+    
+    void report_to(parse_reporter& reporter)
+    {
+        _reporter = &reporter;
+        _resource = reporter.options.resource();
+    }
+    
+    value& result()
+    {
+        return _result;
+    }
+    
+    /** Close everything which is still open, so the entries of unfinished objects end up in \c result. **/
+    void finish()
+    {
+        while (!_open.empty())
+        {
+            if (_open.back()->kind() == kind::object)
+                close_object();
+            else
+                _open.pop_back();
+        }
+    }
+    
+private:
+    value& write(value&& x)
+    {
+        if (_open.empty())
+        {
+            _result = std::move(x);
+            return _result;
+        }
+        
+        value& parent = *_open.back();
+        if (parent.kind() == kind::array)
+        {
+            parent.push_back(std::move(x));
+            return parent[parent.size() - 1];
+        }
+        
+        // the entries of the open object, which do not move while a value being written into one of them is open
+        std::vector<pending_entry>& entries = _entries[_open_objects - 1];
+        entries.push_back({ _key, std::move(x), false });
+        std::size_t earlier = _key_finders[_open_objects - 1].add(entries, entries.size() - 1);
+        if (earlier != key_finder::npos)
+        {
+            entries[earlier].replaced = true;
+            if (_reporter)
+                _reporter->duplicate_key(_key, entries[earlier].val, entries.back().val);
+        }
+        return entries.back().val;
+    }
+    
+    void open_object()
+    {
+        _open.push_back(&write(make_object(_resource)));
+        if (_entries.size() == _open_objects)
+        {
+            _entries.emplace_back();
+            _key_finders.emplace_back();
+        }
+        _key_finders[_open_objects].reset();
+        ++_open_objects;
+    }
+    
+    void close_object()
+    {
+        --_open_objects;
+        add_entries(_entries[_open_objects], 0, *_open.back());
+        _open.pop_back();
+    }
+    
+    virtual void write_null() override                      { write(value()); }
+    virtual void write_object_key(string_view key) override  { _key.assign(key.data(), key.size()); }
+    virtual void write_object_delimiter() override          { }
+    virtual void write_array_delimiter() override           { }
+    virtual void write_string(string_view x) override        { write(make_string(std::string(x), _resource)); }
+    virtual void write_integer(std::int64_t x) override     { write(value(x)); }
+    virtual void write_decimal(double x) override           { write(value(x)); }
+    virtual void write_boolean(bool x) override             { write(value(x)); }
+    
+    virtual void write_object_begin() override { open_object(); }
+    virtual void write_array_begin() override  { _open.push_back(&write(make_array(_resource))); }
+    virtual void write_object_end() override   { close_object(); }
+    virtual void write_array_end() override    { _open.pop_back(); }
+    
+private:
+    parse_reporter*                         _reporter;
+    memory_resource*                        _resource;
+    value                                   _result;
+    std::vector<value*>                     _open;
+    std::vector<std::vector<pending_entry>> _entries;      //!< The entries of each open object, which are kept around.
+    std::vector<key_finder>                 _key_finders;  //!< The \c key_finder for each of \c _entries.
+    std::size_t                             _open_objects; //!< How many of \c _entries are in use.
+    std::string                             _key;
+};
+
+/** Find where the entries of the array in \a input start and end without parsing them. The first of the
+ *  \a separators is the offset of the opening \c '[', followed by the offset of each comma between entries and finally
+ *  the offset of the closing \c ']', so entry \c i is between `separators[i] + 1` and `separators[i + 1]`.
+ *
+ *  \returns \c false if \a input is not something \c parse_parallel can split up: it is not an array, has comments or
+ *   empty entries, is too deeply nested, is unbalanced or has something after the array. It might still be valid, but
+ *   finding out is left to the regular parser.
+**/
+static bool find_array_separators(string_view input, const parse_options& options, std::vector<std::size_t>& separators)
+{
+    const simd_scanner& scanner = active_simd_scanner();
+    const char* const begin = input.data();
+    const char* const end   = begin + input.size();
+
+    const char* pos = scanner.skip_whitespace(begin, end);
+    if (pos == end || *pos != '[')
+        return false;
+    separators.push_back(std::size_t(pos - begin));
+
+    std::size_t depth = 1;
+    bool        empty_entry = true;
+    if (depth == options.max_structure_depth())
+        return false;
+    for (++pos; pos != end; ++pos)
+    {
+        switch (*pos)
+        {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            break;
+        case '"':
+            for (pos = scanner.find_quote_or_backslash(pos + 1, end);
+                 pos != end && *pos == '\\';
+                 pos = scanner.find_quote_or_backslash(pos + 2, end)
+                )
+            {
+                if (pos + 1 == end)
+                    return false;
+            }
+            if (pos == end)
+                return false;
+            empty_entry = false;
+            break;
+        case '[':
+        case '{':
+            if (++depth == options.max_structure_depth())
+                return false;
+            empty_entry = false;
+            break;
+        case ']':
+        case '}':
+            if (--depth == 0)
+            {
+                if (*pos != ']' || empty_entry)
+                    return false;
+                separators.push_back(std::size_t(pos - begin));
+                // anything other than whitespace after the array is an error, unless it is ignored
+                return !options.complete_parse() || scanner.skip_whitespace(pos + 1, end) == end;
+            }
+            break;
+        case ',':
+            if (depth == 1)
+            {
+                if (empty_entry)
+                    return false;
+                separators.push_back(std::size_t(pos - begin));
+                empty_entry = true;
+            }
+            break;
+        case '/':
+            return false;
+        default:
+            empty_entry = false;
+            break;
+        }
+    }
+    return false;
+}
+
+/** Parse a run of array entries separated by commas (without the surrounding brackets) from \a text into the array
+ *  \a out.
+ *
+ *  \returns \c true if there were no problems at all.
+**/
+static bool parse_array_entries(string_view text, const parse_options& options, value& out)
+{
+    tokenizer tokens(text);
+    parse_context context(options, tokens, true);
+    out = make_array(options.resource());
+    try
+    {
+        while (true)
+        {
+            value val;
+            if (!parse_generic(context, val))
+                return false;
+            out.push_back(std::move(val));
+
+            if (!context.next())
+                break;
+            if (context.current_kind() != token_kind::separator)
+                return false;
+        }
+    }
+    catch (const jsonv::parse_error&)
+    {
+        return false;
+    }
+    return context.successful;
+}
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // parse functions                                                                                                    //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -781,9 +1628,8 @@ static value post_parse(detail::parse_context& context, value&& out_)
         throw parse_error(context.problems, out);
 }
 
-value parse(tokenizer& input, const parse_options& options)
+static value parse_all(detail::parse_context& context)
 {
-    detail::parse_context context(options, input);
     value out;
     if (!detail::parse_generic(context, out))
         context.parse_error("No input");
@@ -791,6 +1637,12 @@ value parse(tokenizer& input, const parse_options& options)
     return post_parse(context, std::move(out));
 }
 
+value parse(tokenizer& input, const parse_options& options)
+{
+    detail::parse_context context(options, input);
+    return parse_all(context);
+}
+
 value parse(std::istream& input, const parse_options& options)
 {
     tokenizer tokens(input);
@@ -799,8 +1651,10 @@ value parse(std::istream& input, const parse_options& options)
 
 value parse(const string_view& input, const parse_options& options)
 {
+    // the caller owns input, so the text of tokens stays put
     tokenizer tokens(input);
-    return parse(tokens, options);
+    detail::parse_context context(options, tokens, true);
+    return parse_all(context);
 }
 
 value parse(const char* begin, const char* end, const parse_options& options)
@@ -808,6 +1662,425 @@ value parse(const char* begin, const char* end, const parse_options& options)
     return parse(string_view(begin, std::distance(begin, end)), options);
 }
 
+value parse_file(const std::string& path, const parse_options& options)
+{
+    auto file = std::make_shared<detail::mapped_file>(path);
+    tokenizer tokens(file->contents(), file);
+    detail::parse_context context(options, tokens);
+    return parse_all(context);
+}
+
+value parse_parallel(const string_view& input, const parse_options& options, std::size_t thread_count,
+                     std::size_t min_entries
+                    )
+{
+    thread_count = detail::resolve_thread_count(thread_count);
+    std::vector<std::size_t> separators;
+    if (  thread_count == 1
+       || options.resource() != new_delete_resource()
+       || !detail::find_array_separators(input, options, separators)
+       || separators.size() - 1 < std::max<std::size_t>(min_entries, 2)
+       )
+        return parse(input, options);
+
+    // Split the entries into a few runs for each thread, with about the same number of characters in each run, so
+    // threads which finish early have something to pick up.
+    std::size_t entry_count = separators.size() - 1;
+    std::size_t run_length  = (separators.back() - separators.front()) / std::min(thread_count * 4, entry_count);
+    std::vector<std::size_t> run_starts({ 0 });
+    for (std::size_t idx = 1; idx < entry_count; ++idx)
+        if (separators[idx] - separators[run_starts.back()] >= run_length)
+            run_starts.push_back(idx);
+    run_starts.push_back(entry_count);
+
+    std::vector<value> runs(run_starts.size() - 1);
+    std::atomic<bool>  failed(false);
+    detail::parallel_for(runs.size(), thread_count, [&] (std::size_t run)
+        {
+            if (failed)
+                return;
+
+            std::size_t begin = separators[run_starts[run]] + 1;
+            std::size_t end   = separators[run_starts[run + 1]];
+            if (!detail::parse_array_entries(input.substr(begin, end - begin), options, runs[run]))
+                failed = true;
+        });
+
+    // Let the regular parser find the problems, so they are reported with the right locations and in the right order
+    if (failed)
+        return parse(input, options);
+
+    value out = array();
+    for (value& run : runs)
+        for (value& entry : run.as_array())
+            out.push_back(std::move(entry));
+    return out;
+}
+
+void parse_events(tokenizer& input, encoder& handler, const parse_options& options)
+{
+    detail::event_parser parser(options, handler);
+    while ((options.complete_parse() || !parser.value_complete()) && input.next())
+        parser.push(input.current());
+    parser.finish();
+    parser.throw_if_failed(null);
+}
+
+void parse_events(std::istream& input, encoder& handler, const parse_options& options)
+{
+    tokenizer tokens(input);
+    parse_events(tokens, handler, options);
+}
+
+void parse_events(const string_view& input, encoder& handler, const parse_options& options)
+{
+    tokenizer tokens(input);
+    parse_events(tokens, handler, options);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// incremental_parser                                                                                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class incremental_parser::impl
+{
+public:
+    explicit impl(const parse_options& options) :
+            parser(options, builder),
+            current(status::need_more)
+    {
+        builder.report_to(parser);
+    }
+    
+    /** Push all the tokens in \c pending which are known to be complete to the parser. If \a final is set, there is no
+     *  more input, so every token is complete.
+    **/
+    void run(bool final)
+    {
+        const char* pos = pending.data();
+        const char* end = pending.data() + pending.size();
+        while (pos != end)
+        {
+            if (!parser.options.complete_parse() && parser.value_complete())
+                break;
+            
+            // only the input added since last time can finish a token which was unfinished then
+            if (pos == pending.data() && unfinished > 0 && !final && !might_finish())
+                break;
+            unfinished = 0;
+            
+            token_kind kind;
+            std::size_t length;
+            auto result = detail::attempt_match(pos, end, kind, length);
+            if (!final && pos + length >= end && might_continue(result, kind, string_view(pos, length)))
+            {
+                remember_unfinished(kind, string_view(pos, std::size_t(end - pos)));
+                break;
+            }
+            
+            if (result == detail::match_result::unmatched)
+                kind = kind | token_kind::parse_error_indicator;
+            parser.push(tokenizer::token{ string_view(pos, length), kind });
+            pos += length;
+        }
+        pending.erase(0, std::size_t(pos - pending.data()));
+        
+        if (parser.value_complete())
+        {
+            parser.throw_if_failed(builder.result());
+            current = status::complete;
+        }
+    }
+    
+    /** Remember how much of the unfinished token \a text (which will be at the start of \c pending) \c might_finish
+     *  does not need to look at again. Only strings and numbers get this, since those are the tokens which can be long.
+    **/
+    void remember_unfinished(token_kind kind, string_view text)
+    {
+        if (kind == token_kind::string)
+            unfinished = 1;
+        else if (kind == token_kind::number && is_digit(text[text.size() - 1]))
+            unfinished = text.size();
+    }
+    
+    /** Check if the input added since the unfinished token at the start of \c pending was last looked at could finish
+     *  it. Without this, a long string or number arriving in many chunks would be matched from its start for each one.
+    **/
+    bool might_finish()
+    {
+        const char* begin = pending.data();
+        const char* end   = begin + pending.size();
+        const char* pos   = begin + unfinished;
+        if (*begin == '\"')
+        {
+            // Look for the closing quote, skipping escapes. A backslash at the end is looked at again next time, since
+            // what it escapes is not here yet.
+            const detail::simd_scanner& scanner = detail::active_simd_scanner();
+            for (pos = scanner.find_quote_or_backslash(pos, end);
+                 pos != end && *pos == '\\' && pos + 1 != end;
+                 pos = scanner.find_quote_or_backslash(pos + 2, end)
+                )
+            { }
+            unfinished = std::size_t(pos - begin);
+            return pos != end && *pos == '\"';
+        }
+        else
+        {
+            // a number which ends in a digit continues for as long as there are more digits
+            pos = std::find_if(pos, end, [] (char c) { return !is_digit(c); });
+            unfinished = std::size_t(pos - begin);
+            return pos != end;
+        }
+    }
+    
+    static bool is_digit(char c)
+    {
+        return '0' <= c && c <= '9';
+    }
+    
+    /** Could a token which runs to the end of the input so far be longer once more input arrives? **/
+    static bool might_continue(detail::match_result result, token_kind kind, string_view text)
+    {
+        if (result == detail::match_result::unmatched)
+            return true;
+        
+        switch (kind)
+        {
+        case token_kind::array_begin:
+        case token_kind::array_end:
+        case token_kind::object_begin:
+        case token_kind::object_end:
+        case token_kind::object_key_delimiter:
+        case token_kind::separator:
+        case token_kind::string:
+            return false;
+        case token_kind::comment:
+            // a line comment goes until the end of the line, but a block comment has a definite end
+            return text.size() < 2U || text[1] == '/';
+        default:
+            return true;
+        }
+    }
+    
+public:
+    detail::value_builder builder;
+    detail::event_parser  parser;
+    std::string           pending;
+    std::size_t           unfinished = 0; //!< Characters of the token at the start of \c pending known not to finish it.
+    status                current;
+};
+
+incremental_parser::incremental_parser(const parse_options& options) :
+        _impl(new impl(options))
+{ }
+
+incremental_parser::~incremental_parser() noexcept
+{ }
+
+incremental_parser::status incremental_parser::feed(string_view chunk)
+{
+    _impl->pending.append(chunk.data(), chunk.size());
+    _impl->run(false);
+    return _impl->current;
+}
+
+incremental_parser::status incremental_parser::finish()
+{
+    _impl->run(true);
+    _impl->parser.finish();
+    _impl->builder.finish();
+    _impl->parser.throw_if_failed(_impl->builder.result());
+    if (_impl->parser.value_complete())
+        _impl->current = status::complete;
+    return _impl->current;
+}
+
+value& incremental_parser::result()
+{
+    if (_impl->current == status::complete)
+        return _impl->builder.result();
+    else
+        throw std::logic_error("Cannot get result -- feed or finish must return status::complete.");
+}
+
+void incremental_parser::reset()
+{
+    std::unique_ptr<impl> next(new impl(_impl->parser.options));
+    next->pending    = std::move(_impl->pending);
+    next->unfinished = _impl->unfinished;
+    _impl = std::move(next);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// json_lines_reader                                                                                                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class json_lines_reader::impl
+{
+public:
+    /** A line of input which is not blank. **/
+    struct line_info
+    {
+        string_view text;
+        std::size_t number;
+        std::size_t offset;   //!< The number of characters in the input before this line.
+    };
+    
+public:
+    explicit impl(std::istream* stream, string_view text, const parse_options& options) :
+            options(options),
+            stream(stream),
+            text(text),
+            position(0),
+            line_number(0),
+            offset(0),
+            buffers(1),
+            no_input(string_view()),
+            context(options, no_input, !stream)
+    { }
+    
+    /** Find the next line which is not blank. If the text has to be copied out of the stream, it goes in \a buffer.
+     *  
+     *  \returns \c false if there are no more lines.
+    **/
+    bool read_line(line_info& out, std::string& buffer)
+    {
+        const detail::simd_scanner& scanner = detail::active_simd_scanner();
+        while (true)
+        {
+            string_view line;
+            std::size_t length;
+            if (stream)
+            {
+                if (!std::getline(*stream, buffer))
+                    return false;
+                line   = buffer;
+                length = buffer.size() + 1;
+            }
+            else
+            {
+                if (position == text.size())
+                    return false;
+                
+                const char* begin = text.data() + position;
+                const char* end   = static_cast<const char*>(std::memchr(begin, '\n', text.size() - position));
+                line     = string_view(begin, end ? std::size_t(end - begin) : text.size() - position);
+                length   = std::min(line.size() + 1, text.size() - position);
+                position += length;
+            }
+            
+            out.number = ++line_number;
+            out.offset = offset;
+            offset += length;
+            
+            // a '\r' would count as another line in problem locations
+            if (!line.empty() && line.data()[line.size() - 1] == '\r')
+                line = string_view(line.data(), line.size() - 1);
+            out.text = line;
+            if (scanner.skip_whitespace(line.data(), line.data() + line.size()) != line.data() + line.size())
+                return true;
+        }
+    }
+    
+    static value parse_line(detail::parse_context& context, const line_info& line)
+    {
+        tokenizer tokens(line.text);
+        context.restart(tokens, line.number, line.offset);
+        return parse_all(context);
+    }
+    
+public:
+    parse_options            options;
+    std::istream*            stream;
+    string_view              text;
+    std::size_t              position;
+    std::size_t              line_number;
+    std::size_t              offset;
+    std::deque<std::string>  buffers;   //!< Text of the lines from \c stream, which a std::deque never moves.
+    std::vector<line_info>   batch;
+    tokenizer                no_input;
+    detail::parse_context    context;
+};
+
+json_lines_reader::json_lines_reader(std::istream& input, const parse_options& options) :
+        _impl(new impl(&input, string_view(), options))
+{ }
+
+json_lines_reader::json_lines_reader(string_view input, const parse_options& options) :
+        _impl(new impl(nullptr, input, options))
+{ }
+
+json_lines_reader::~json_lines_reader() noexcept
+{ }
+
+bool json_lines_reader::next(value& out)
+{
+    impl::line_info line;
+    if (!_impl->read_line(line, _impl->buffers[0]))
+        return false;
+    
+    out = impl::parse_line(_impl->context, line);
+    return true;
+}
+
+std::size_t json_lines_reader::next_batch(std::vector<value>& out, std::size_t max_count, std::size_t thread_count)
+{
+    std::vector<impl::line_info>& lines = _impl->batch;
+    lines.clear();
+    impl::line_info line;
+    while (lines.size() < max_count)
+    {
+        // lines from a stream each need their own buffer, which is only made once there might be a line to put in it
+        if (_impl->stream && lines.size() == _impl->buffers.size())
+            _impl->buffers.emplace_back();
+        if (!_impl->read_line(line, _impl->buffers[_impl->stream ? lines.size() : 0]))
+            break;
+        lines.push_back(line);
+    }
+    
+    if (_impl->options.resource() != new_delete_resource())
+        thread_count = 1;
+    thread_count = detail::resolve_thread_count(thread_count);
+    
+    // a few runs of lines for each thread, so threads which finish early have something to pick up
+    std::size_t first     = out.size();
+    std::size_t run_count = std::min(lines.size(), thread_count * 4);
+    std::vector<parse_error::problem_list> run_problems(run_count);
+    out.resize(first + lines.size());
+    detail::parallel_for(run_count, thread_count, [&] (std::size_t run)
+        {
+            tokenizer             no_input{ string_view() };
+            detail::parse_context context(_impl->options, no_input, !_impl->stream);
+            for (std::size_t idx = lines.size() * run / run_count; idx < lines.size() * (run + 1) / run_count; ++idx)
+            {
+                try
+                {
+                    out[first + idx] = impl::parse_line(context, lines[idx]);
+                }
+                catch (const parse_error& err)
+                {
+                    out[first + idx] = err.partial_result();
+                    run_problems[run].insert(run_problems[run].end(), err.problems().begin(), err.problems().end());
+                }
+            }
+        });
+    
+    parse_error::problem_list problems;
+    for (const parse_error::problem_list& run : run_problems)
+        for (const parse_error::problem& problem : run)
+            if (problems.empty() || problems.size() < _impl->options.max_failures())
+                problems.push_back(problem);
+    if (!problems.empty())
+        throw parse_error(std::move(problems), null);
+    
+    return lines.size();
+}
+
+std::size_t json_lines_reader::line() const
+{
+    return _impl->line_number;
+}
+
 value operator"" _json(const char* str, std::size_t len)
 {
     return parse(string_view(str, len));
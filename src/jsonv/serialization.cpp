@@ -16,6 +16,7 @@
 #include <jsonv/value.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <set>
 #include <sstream>
 #include <unordered_map>
@@ -30,12 +31,22 @@ namespace jsonv
 
 extractor::~extractor() noexcept = default;
 
+void extractor::extract_lazy(const extraction_context& context, const lazy_value& from, void* into) const
+{
+    extract(context, from.to_value(), into);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // serializer                                                                                                         //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 serializer::~serializer() noexcept = default;
 
+void serializer::to_encoder(const serialization_context& context, const void* from, event_writer& out) const
+{
+    out.value(to_json(context, from));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // adapter                                                                                                            //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -333,6 +344,26 @@ formats formats::compose(const list& bases)
 formats::~formats() noexcept
 { }
 
+formats formats::flatten() const
+{
+    formats out;
+    std::unordered_set<const data*> visited;
+    // visit in the same order as find_impl searches, so the first one found for each type is the one kept
+    std::function<void (const data*)> visit = [&] (const data* node)
+    {
+        if (!visited.insert(node).second)
+            return;
+        
+        out._data->extractors.insert(begin(node->extractors), end(node->extractors));
+        out._data->serializers.insert(begin(node->serializers), end(node->serializers));
+        out._data->owned_items.insert(begin(node->owned_items), end(node->owned_items));
+        for (const auto& sub : node->roots)
+            visit(sub.get());
+    };
+    visit(_data.get());
+    return out;
+}
+
 const extractor& formats::get_extractor(std::type_index type) const
 {
     const extractor* ex = _data->find_extractor(type);
@@ -624,11 +655,13 @@ extraction_context::extraction_context() :
 
 extraction_context::~extraction_context() noexcept = default;
 
-void extraction_context::extract(const std::type_info& type, const value& from, void* into) const
+/** Run \a extract, turning anything it throws which is not already an \c extraction_error into one for \a context. **/
+template <typename FExtract>
+static void wrap_extraction_errors(const extraction_context& context, const FExtract& extract)
 {
     try
     {
-        formats().extract(type, from, into, *this);
+        extract();
     }
     catch (const extraction_error&)
     {
@@ -636,14 +669,34 @@ void extraction_context::extract(const std::type_info& type, const value& from,
     }
     catch (const std::exception& ex)
     {
-        throw extraction_error(*this, ex.what());
+        throw extraction_error(context, ex.what());
     }
     catch (...)
     {
-        throw extraction_error(*this, "");
+        throw extraction_error(context, "");
     }
 }
 
+void extraction_context::extract(const std::type_info& type, const value& from, void* into) const
+{
+    wrap_extraction_errors(*this, [&] { formats().extract(type, from, into, *this); });
+}
+
+void extraction_context::extract(const std::type_info& type, const lazy_value& from, void* into) const
+{
+    wrap_extraction_errors(*this, [&] { formats().get_extractor(type).extract_lazy(*this, from, into); });
+}
+
+void extraction_context::extract(const extractor& ex, const value& from, void* into) const
+{
+    wrap_extraction_errors(*this, [&] { ex.extract(*this, from, into); });
+}
+
+void extraction_context::extract(const extractor& ex, const lazy_value& from, void* into) const
+{
+    wrap_extraction_errors(*this, [&] { ex.extract_lazy(*this, from, into); });
+}
+
 void extraction_context::extract_sub(const std::type_info& type,
                                      const value&          from,
                                      jsonv::path           subpath,
@@ -652,22 +705,18 @@ void extraction_context::extract_sub(const std::type_info& type,
 {
     extraction_context sub(*this);
     sub._path += subpath;
-    try
-    {
-        return sub.extract(type, from.at_path(subpath), into);
-    }
-    catch (const extraction_error&)
-    {
-        throw;
-    }
-    catch (const std::exception& ex)
-    {
-        throw extraction_error(sub, ex.what());
-    }
-    catch (...)
-    {
-        throw extraction_error(sub, "");
-    }
+    wrap_extraction_errors(sub, [&] { sub.extract(type, from.at_path(subpath), into); });
+}
+
+void extraction_context::extract_sub(const std::type_info& type,
+                                     const lazy_value&     from,
+                                     jsonv::path           subpath,
+                                     void*                 into
+                                    ) const
+{
+    extraction_context sub(*this);
+    sub._path += subpath;
+    wrap_extraction_errors(sub, [&] { sub.extract(type, from.at_path(subpath), into); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -692,4 +741,9 @@ value serialization_context::to_json(const std::type_info& type, const void* fro
     return formats().to_json(type, from, *this);
 }
 
+void serialization_context::to_encoder(const std::type_info& type, const void* from, event_writer& out) const
+{
+    formats().get_serializer(type).to_encoder(*this, from, out);
+}
+
 }
@@ -111,33 +111,34 @@ void tokenizer::set_min_buffer_size(tokenizer::size_type sz)
 
 tokenizer::tokenizer(string_view input) :
         _input(input),
-        _position(_input.data())
+        _position(_input.data()),
+        _source(nullptr),
+        _buffer(nullptr)
 { }
 
-tokenizer::tokenizer(std::shared_ptr<std::string> input) :
-        _input(*input),
+tokenizer::tokenizer(string_view input, std::shared_ptr<const void> owner) :
+        _input(input),
         _position(_input.data()),
-        _track(std::move(input))
+        _source(nullptr),
+        _buffer(nullptr),
+        _track(std::move(owner))
 { }
 
-static std::string load_single_string(std::istream& input)
+tokenizer::tokenizer(std::istream& input) :
+        _input(),
+        _position(nullptr),
+        _source(&input),
+        _buffer(nullptr)
 {
-    std::string out;
-    char buffer[16 * 1024];
-
-    while (input.read(buffer, sizeof buffer))
-    {
-        out.append(buffer, sizeof buffer);
-    }
-    out.append(buffer, input.gcount());
-
-    return out;
+    auto buffer = std::make_shared<std::string>();
+    _buffer = buffer.get();
+    _track  = std::move(buffer);
+    
+    _buffer->reserve(min_buffer_size());
+    _input    = string_view(_buffer->data(), 0);
+    _position = _input.data();
 }
 
-tokenizer::tokenizer(std::istream& input) :
-        tokenizer(std::make_shared<std::string>(load_single_string(input)))
-{ }
-
 tokenizer::~tokenizer() noexcept
 { }
 
@@ -156,34 +157,70 @@ const tokenizer::token& tokenizer::current() const
 
 bool tokenizer::next()
 {
-    auto valid = [this] (const string_view& new_current, token_kind new_kind)
-                 {
-                     _current.text = new_current;
-                     _current.kind = new_kind;
-                     return true;
-                 };
-    
-    if (!_current.text.empty())
+    // move past the current token (unless a previous call already hit the end of input)
+    if (!_current.text.empty() && _position < _input.end())
         _position += _current.text.size();
-
-    while (_position < _input.end())
+    
+    while (true)
     {
         token_kind kind;
         size_type  match_len;
         auto       result = detail::attempt_match(_position, _input.end(), *&kind, *&match_len);
-
+        
+        // A token running into the end of the buffer might continue in data we have not read yet -- get more input and
+        // attempt the match again.
+        if (_position + match_len >= _input.end() && refill())
+            continue;
+        
+        if (_position == _input.end())
+            return false;
+        
         if (result == detail::match_result::unmatched)
         {
             // unmatched entry -- this token is invalid
             kind = kind | token_kind::parse_error_indicator;
         }
-        return valid(string_view(_position, match_len), kind);
+        _current.text = string_view(_position, match_len);
+        _current.kind = kind;
+        return true;
     }
+}
 
-    return false;
+bool tokenizer::refill()
+{
+    if (!_source)
+        return false;
+    
+    // Keep the current token around, since the caller is allowed to look at it until the next successful call to next.
+    const char* keep_from = _current.text.data() ? std::min(_current.text.data(), _position) : _position;
+    size_type   keep_len  = size_type(_input.end() - keep_from);
+    size_type   token_off = _current.text.data() ? size_type(_current.text.data() - keep_from) : 0;
+    size_type   pos_off   = size_type(_position - keep_from);
+    
+    _buffer->erase(0, size_type(keep_from - _buffer->data()));
+    
+    // Read at least min_buffer_size, but grow geometrically so a huge token does not cause quadratic rescanning.
+    size_type target = std::max({ keep_len * 2, keep_len + min_buffer_size(), _buffer->capacity() });
+    _buffer->resize(target);
+    _source->read(&(*_buffer)[keep_len], std::streamsize(target - keep_len));
+    size_type read_len = size_type(_source->gcount());
+    _buffer->resize(keep_len + read_len);
+    
+    if (!*_source)
+        _source = nullptr;
+    
+    _input    = string_view(_buffer->data(), _buffer->size());
+    _position = _input.data() + pos_off;
+    if (_current.text.data())
+        _current.text = string_view(_input.data() + token_off, _current.text.size());
+    
+    return read_len > 0;
 }
 
-void tokenizer::buffer_reserve(size_type)
-{ }
+void tokenizer::buffer_reserve(size_type sz)
+{
+    if (_buffer)
+        _buffer->reserve(sz);
+}
 
 }
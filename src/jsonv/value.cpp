@@ -70,11 +70,30 @@ kind_error::~kind_error() noexcept
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 value::value(const std::string& val) :
+        value(std::string(val))
+{ }
+
+value::value(std::string&& val) :
         _kind(jsonv::kind::null)
 {
-    _data.string = new detail::string_impl;
+    _data.string = detail::create_in<detail::string_impl>(new_delete_resource(), std::move(val));
     _kind = jsonv::kind::string;
-    _data.string->_string = val;
+}
+
+value detail::make_string(std::string&& source, memory_resource* resource)
+{
+    value x;
+    x._data.string = create_in<string_impl>(resource, std::move(source), resource);
+    x._kind = jsonv::kind::string;
+    return x;
+}
+
+value detail::borrow_string(string_view source, memory_resource* resource)
+{
+    value x;
+    x._data.string = create_in<string_impl>(resource, string_impl::borrow_tag(), source, resource);
+    x._kind = jsonv::kind::string;
+    return x;
 }
 
 value::value(const string_view& val) :
@@ -140,7 +159,7 @@ value::value(const value& other) :
         _data.array = other._data.array->clone();
         break;
     case jsonv::kind::string:
-        _data.string = other._data.string->clone();
+        _data.string = other._data.string->share();
         break;
     case jsonv::kind::integer:
         _data.integer = other._data.integer;
@@ -373,13 +392,13 @@ void value::clear()
     switch (_kind)
     {
     case jsonv::kind::object:
-        delete _data.object;
+        detail::destroy(_data.object);
         break;
     case jsonv::kind::array:
-        delete _data.array;
+        detail::destroy(_data.array);
         break;
     case jsonv::kind::string:
-        delete _data.string;
+        _data.string->release();
         break;
     case jsonv::kind::integer:
     case jsonv::kind::decimal:
@@ -396,13 +415,13 @@ void value::clear()
 const std::string& value::as_string() const
 {
     check_type(jsonv::kind::string, _kind);
-    return _data.string->_string;
+    return _data.string->str();
 }
 
 string_view value::as_string_view() const &
 {
     check_type(jsonv::kind::string, _kind);
-    return string_view(_data.string->_string);
+    return _data.string->view();
 }
 
 std::wstring value::as_wstring() const
@@ -479,16 +498,20 @@ bool value::operator>=(const value& other) const
 
 std::ostream& operator<<(std::ostream& stream, const value& val)
 {
-    ostream_encoder encoder(stream);
+    buffer_encoder encoder([&stream] (string_view chunk) { stream.write(chunk.data(), std::streamsize(chunk.size())); },
+                           4096
+                          );
     encoder.encode(val);
+    encoder.flush();
     return stream;
 }
 
 std::string to_string(const value& val)
 {
-    std::ostringstream os;
-    os << val;
-    return os.str();
+    std::string out;
+    buffer_encoder encoder(out);
+    encoder.encode(val);
+    return out;
 }
 
 bool value::empty() const noexcept
@@ -500,7 +523,7 @@ bool value::empty() const noexcept
     case jsonv::kind::array:
         return _data.array->empty();
     case jsonv::kind::string:
-        return _data.string->_string.empty();
+        return _data.string->view().empty();
     case jsonv::kind::null:
         return true; // by definition a null value is empty
     case jsonv::kind::integer:
@@ -524,7 +547,7 @@ value::size_type value::size() const
     case jsonv::kind::array:
         return _data.array->size();
     case jsonv::kind::string:
-        return _data.string->_string.size();
+        return _data.string->view().size();
     case jsonv::kind::integer:
     case jsonv::kind::decimal:
     case jsonv::kind::boolean: